@@ -8,13 +8,19 @@
 	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 	*/
 // includes
-	#include <sys/select.h> // select
 	#include <stdio.h>      // printf fflush
 	#include <unistd.h>     // read
 	#include <termios.h>    // termios
 	#include <stdlib.h>     // malloc calloc free atoi
 	#include <errno.h>      // errno
 	#include "hoof.h"
+// defines
+	#define input_size 4096
+// state
+	// everything that was waiting on stdin is read at once, and handled a byte at a time from here
+	b input[ input_size ] ;
+	n input_length = 0 ;
+	n input_index = 0 ;
 #ifdef hoof_debug
 	// force failure counters
 		static n fail_on_count = 0 ;
@@ -95,17 +101,22 @@
 			}
 	#endif
 // functions
-	n key_available()
+	n input_fill( void )
 		{
-		struct timeval timeout ;
-		fd_set rdset ;
-
-		FD_ZERO( & rdset ) ;
-		FD_SET( STDIN_FILENO , & rdset ) ;
-		timeout . tv_sec  = 0 ;
-		timeout . tv_usec = 100000 ;
-
-		return select( STDIN_FILENO + 1 , & rdset , NULL , NULL , & timeout ) ; 
+		n rc = 0 ;
+		// what we echoed since we last waited goes out in one write
+		fflush( stdout ) ;
+		// stdin is the only thing we wait on, so we just block in read until there are keys, and get all of them
+		do
+			{
+			rc = read( STDIN_FILENO , input , input_size ) ;
+			} while ( rc == -1 && errno == EINTR ) ;
+		if ( rc > 0 )
+			{
+			input_length = rc ;
+			input_index = 0 ;
+			}
+		return rc ;
 		}
 // main
 	int main( int argc, char * * argv )
@@ -119,8 +130,8 @@
 		n interactive = 0 ;
 		n done = 0 ;
 		struct termios old_tio , new_tio ;
-		n read_num = 0 ;
-		char ch[ 3 ] = { 0 , 0 , 0 } ;
+		b ch = 0 ;
+		n escape = 0 ;
 		n input_word_index = 0 ;
 		n i = 0 ;
 
@@ -155,6 +166,9 @@
 			tcgetattr( STDIN_FILENO , & old_tio ) ;
 			new_tio = old_tio ;
 			new_tio . c_lflag &= ( ~ ICANON & ~ ECHO ) ;
+			// read waits for at least one key, without a timeout
+			new_tio . c_cc[ VMIN ] = 1 ;
+			new_tio . c_cc[ VTIME ] = 0 ;
 			tcsetattr( STDIN_FILENO , TCSANOW , & new_tio ) ;
 
 			#ifdef hoof_debug
@@ -200,62 +214,59 @@
 			interface . input_word[ 0 ] = '\0' ;
 			while ( 1 )
 				{
-				// TODO see if we can use just if key_available here
-				if ( ( interactive && key_available( ) ) || ( ! interactive ) )
+				// once we've handled everything that was typed, wait for more
+				if ( input_index == input_length )
 					{
-					// note : need to read 3 because some keys like left come through in 3 bytes
-					if ( interactive )
+					// if we dont read a byte then we are out of input
+					if ( input_fill( ) <= 0 )
+						{
+						goto cleanup ;
+						}
+					}
+				ch = input[ input_index ] ;
+				input_index += 1 ;
+				// keys like left come through as 3 bytes, escape [ and a letter, and we skip them
+				if ( interactive && ( escape > 0 || ch == 27 ) )
+					{
+					escape = ( escape + 1 ) % 3 ;
+					if ( escape != 2 || ch == '[' )
 						{
-						read_num = read( STDIN_FILENO , ch , 3 ) ;
+						continue ;
 						}
-					else
+					// escape and not [ wasn't a key like left, so ch is just a character
+					escape = 0 ;
+					}
+				// if backspace
+				if ( ch == 127 )
+					{
+					if ( interactive && input_word_index > 0 )
 						{
-						read_num = read( STDIN_FILENO , ch , 1 ) ;
+						input_word_index -= 1 ;
+						interface.input_word[ input_word_index ] = '\0' ;
+						printf( "\b \b" ) ;
 						}
-					// if we're not interactive and we dont read a byte then we are out of input
-					if ( ( ! interactive) && read_num == 0 )
+					}
+				// else if whitespace
+				else if ( ch == ' ' || ch == '\n' || ch == '\r' )
+					{
+					if ( interactive )
 						{
-						goto cleanup ;
+						printf( " " ) ;
 						}
-					if ( read_num == 1 )
+					// we got a word
+					break ;
+					}
+				// else character
+				else if ( input_word_index < hoof_max_word_length )
+					{
+					interface . input_word[ input_word_index ] = ch ;
+					input_word_index += 1 ;
+					interface.input_word[ input_word_index ] = '\0' ;
+					if ( interactive )
 						{
-						// if backspace
-						if ( ch[ 0 ] == 127 )
-							{
-							if ( interactive && input_word_index > 0 )
-								{
-								input_word_index -= 1 ;
-								interface.input_word[ input_word_index ] = '\0' ;
-								printf( "\b \b" ) ;
-								fflush( stdout ) ;
-								}
-							}
-						// else if whitespace
-						else if ( ch[ 0 ] == ' ' || ch[ 0 ] == '\n' || ch[ 0 ] == '\r' )
-							{
-							if ( interactive )
-								{
-								printf( " " ) ;
-								fflush( stdout ) ;
-								}
-							// we got a word
-							break ;
-							}
-						// else character
-						else if ( input_word_index < hoof_max_word_length )
-							{
-							interface . input_word[ input_word_index ] = ch[ 0 ] ;
-							input_word_index += 1 ;
-							interface.input_word[ input_word_index ] = '\0' ;
-
-							if ( interactive )
-								{
-								printf( "%c" , ch[ 0 ] ) ;
-								fflush( stdout ) ;
-								}
-							}
+						printf( "%c" , ch ) ;
 						}
-					} // end if key available
+					}
 				} // end while
 			// give input to hoof
 			rc = hoof_do( hoof , & interface ) ;
@@ -8,45 +8,119 @@
 	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 	*/
 // includes
-	#include <sys/select.h> // select
 	#include <sys/ioctl.h>  // ioctl
+	#include <poll.h>       // poll
+	#include <fcntl.h>      // fcntl
 	#include <stdio.h>      // printf fflush
-	#include <unistd.h>     // read
+	#include <unistd.h>     // read write pipe
 	#include <termios.h>    // termios , struct winsize
 	#include <signal.h>     // signal
 	#include <stdlib.h>     // malloc calloc free atoi
+	#include <string.h>     // memset strerror
 	#include <errno.h>      // errno
 	#include "hoof.h"
 // defines
 	#define history_size 512
+	#define input_size 4096
 // state
-	volatile b window_size_changed = 0 ;
+	b window_size_changed = 0 ;
+	// the signal handler writes a byte here, so waiting on stdin also wakes up when the window size changes
+	int signal_pipe[ 2 ] = { -1 , -1 } ;
+	// everything that was waiting on stdin is read at once, and handled a byte at a time from here
+	b input[ input_size ] ;
+	n input_length = 0 ;
+	n input_index = 0 ;
 	n window_width = 80 ;
 	n window_height = 80 ;
+	// hoof draws in to the grid, and we send the terminal the rows that changed in one write
+	struct hoof_grid grid = { 0 , 0 , NULL , NULL } ;
+	b * output = NULL ;
+	n output_length = 0 ;
 // functions
+	n write_all( int fd , const b * buffer , n length )
+		{
+		ssize_t written = 0 ;
+		// a write can be cut short, or interrupted by the window size signal, so keep going until it's all out
+		while ( length > 0 )
+			{
+			written = write( fd , buffer , length ) ;
+			if ( written == -1 && errno == EINTR )
+				{
+				continue ;
+				}
+			if ( written <= 0 )
+				{
+				return -1 ;
+				}
+			buffer += written ;
+			length -= written ;
+			}
+		return 0 ;
+		}
 	void signal_window_size_changed( int sig )
 		{
-		window_size_changed = 1 ;
+		int saved_errno = errno ;
+		// if the pipe is full there's already a byte saying so, so a failed write is fine
+		write_all( signal_pipe[ 1 ] , ( b * ) "" , 1 ) ;
+		errno = saved_errno ;
 		}
-	n key_available( void )
+	n signal_pipe_open( void )
 		{
-		struct timeval timeout ;
-		fd_set rdset ;
-		int rc ;
+		if ( pipe( signal_pipe ) != 0 )
+			{
+			return -1 ;
+			}
+		// neither end can block, the handler can't wait and we drain it until it's empty
+		if ( fcntl( signal_pipe[ 0 ] , F_SETFL , fcntl( signal_pipe[ 0 ] , F_GETFL ) | O_NONBLOCK ) != 0 )
+			{
+			return -1 ;
+			}
+		if ( fcntl( signal_pipe[ 1 ] , F_SETFL , fcntl( signal_pipe[ 1 ] , F_GETFL ) | O_NONBLOCK ) != 0 )
+			{
+			return -1 ;
+			}
+		return 0 ;
+		}
+	n input_wait( void )
+		{
+		struct pollfd fds[ 2 ] ;
+		b signals[ 16 ] ;
+		n rc = 0 ;
 
-		FD_ZERO( & rdset ) ;
-		FD_SET( STDIN_FILENO , & rdset ) ;
-		timeout . tv_sec  = 0 ;
-		timeout . tv_usec = 100000 ;
+		fds[ 0 ] . fd = STDIN_FILENO ;
+		fds[ 0 ] . events = POLLIN ;
+		fds[ 1 ] . fd = signal_pipe[ 0 ] ;
+		fds[ 1 ] . events = POLLIN ;
 
-		errno = 0 ;
+		// no timeout, we sleep until there's a key or the window size changes
 		do
 			{
-			rc = select( STDIN_FILENO + 1 , & rdset , NULL , NULL , & timeout ) ; 
+			rc = poll( fds , 2 , -1 ) ;
 			} while ( rc == -1 && errno == EINTR ) ;
-		if ( rc > 0 )
+		if ( rc == -1 )
+			{
+			return -1 ;
+			}
+		if ( fds[ 1 ] . revents & POLLIN )
 			{
-			return 1 ;
+			while ( read( signal_pipe[ 0 ] , signals , sizeof( signals ) ) > 0 )
+				{
+				}
+			window_size_changed = 1 ;
+			}
+		if ( fds[ 0 ] . revents & ( POLLIN | POLLHUP | POLLERR ) )
+			{
+			// get every key that's waiting, so a burst of typing is handled before we draw again
+			do
+				{
+				rc = read( STDIN_FILENO , input , input_size ) ;
+				} while ( rc == -1 && errno == EINTR ) ;
+			if ( rc <= 0 )
+				{
+				return -1 ;
+				}
+			input_length = rc ;
+			input_index = 0 ;
 			}
 		return 0 ;
 		}
@@ -57,50 +131,131 @@
 		window_width = winsize . ws_col ;
 		window_height = winsize . ws_row ;
 		}
-	void draw_callback( n draw_mode , n column , n row , b * text )
+	n grid_resize( void )
 		{
-		if ( row <= 0 )
+		n i = 0 ;
+		free( grid . cells ) ;
+		free( grid . dirty ) ;
+		free( output ) ;
+		grid . cells = NULL ;
+		grid . dirty = NULL ;
+		output = NULL ;
+		// the last column is the scrollbar
+		grid . columns = window_width - 1 ;
+		grid . rows = window_height - 1 ;
+		// without room for a row and a column there's no grid, and nothing is drawn until the window grows
+		if ( grid . columns < 1 || grid . rows < 1 )
+			{
+			grid . columns = 0 ;
+			grid . rows = 0 ;
+			return 0 ;
+			}
+		grid . cells = malloc( sizeof( struct hoof_cell ) * grid . columns * grid . rows ) ;
+		grid . dirty = calloc( hoof_grid_dirty_bytes( grid . rows ) , 1 ) ;
+		// a cell can need an escape to change the draw mode as well as its character
+		output = malloc( window_height * ( window_width * 12 + 48 ) + 64 ) ;
+		if ( grid . cells == NULL || grid . dirty == NULL || output == NULL )
 			{
-			return ;
+			return -1 ;
 			}
-		if ( row > window_width )
+		// the screen was just cleared
+		for ( i = 0 ; i < grid . columns * grid . rows ; i += 1 )
 			{
-			return ;
+			grid . cells[ i ] . character = ' ' ;
+			grid . cells[ i ] . draw_mode = hoof_draw_normal ;
 			}
-		// if drawing off screen to left, increment text until we're back on screen
-		while ( column <= 0 )
+		return 0 ;
+		}
+	void output_row_start( n row )
+		{
+		output_length += sprintf( ( char * ) output + output_length , "\x1b[%jd;1f\x1b[2K" , row ) ;
+		}
+	n draw_everything( struct hoof * hoof, struct hoof_interface * interface , b * history )
+		{
+		n row = 0 ;
+		n column = 0 ;
+		n draw_mode = hoof_draw_normal ;
+		struct hoof_cell * cell = NULL ;
+		b * text = NULL ;
+		n first = 0 ;
+		n count = 0 ;
+		n total = 0 ;
+		n track = 0 ;
+		n thumb = 0 ;
+		n thumb_size = 0 ;
+		output_length = 0 ;
+		// the window is too small for a grid
+		if ( grid . cells == NULL )
+			{
+			return 0 ;
+			}
+		// draw the rows of hoof state that changed
+		if ( hoof_draw_grid( hoof , & grid , interface ) == hoof_rc_success )
 			{
-			if ( ( * text ) == '\0' )
+			for ( row = 1 ; row <= grid . rows ; row += 1 )
 				{
-				return ;
+				if ( ! hoof_grid_dirty( & grid , row ) )
+					{
+					continue ;
+					}
+				output_row_start( row ) ;
+				draw_mode = hoof_draw_normal ;
+				for ( column = 1 ; column <= grid . columns ; column += 1 )
+					{
+					cell = & grid . cells[ ( row - 1 ) * grid . columns + column - 1 ] ;
+					if ( cell -> draw_mode != draw_mode )
+						{
+						draw_mode = cell -> draw_mode ;
+						if ( draw_mode == hoof_draw_current )
+							{
+							output_length += sprintf( ( char * ) output + output_length , "\x1b[0m\x1b[32m" ) ;
+							}
+						else if ( draw_mode == hoof_draw_cursor )
+							{
+							output_length += sprintf( ( char * ) output + output_length , "\x1b[0m\x1b[42m" ) ;
+							}
+						else
+							{
+							output_length += sprintf( ( char * ) output + output_length , "\x1b[0m" ) ;
+							}
+						}
+					output[ output_length ] = cell -> character ;
+					output_length += 1 ;
+					}
+				output_length += sprintf( ( char * ) output + output_length , "\x1b[0m" ) ;
 				}
-			column += 1 ;
-			text += 1 ;
+			memset( grid . dirty , 0 , hoof_grid_dirty_bytes( grid . rows ) ) ;
 			}
-		if ( draw_mode == hoof_draw_current )
+		// where the screen is in the page, at the end of the title line and as a scrollbar down the last column
+		hoof_draw_view( hoof , & first , & count , & total ) ;
+		if ( window_width > 24 )
 			{
-			printf( "\x1b[32m" ) ;
+			output_length += sprintf( ( char * ) output + output_length , "\x1b[1;%jdf\x1b[K%22jd of %jd" , window_width - 24 , first , total ) ;
 			}
-		printf( "\x1b[%jd;%jdf%s" , row , column , text );
-		if ( draw_mode == hoof_draw_cursor )
+		track = window_height - 2 ;
+		if ( total > 0 && track > 0 )
 			{
-			printf( "\x1b[42m " ) ;
+			thumb = ( first - 1 ) * track / total ;
+			thumb_size = count * track / total ;
+			if ( thumb_size < 1 )
+				{
+				thumb_size = 1 ;
+				}
+			for ( row = 0 ; row < track ; row += 1 )
+				{
+				output_length += sprintf( ( char * ) output + output_length , "\x1b[%jd;%jdf%c" , row + 2 , window_width , ( row >= thumb && row < thumb + thumb_size ) ? '#' : '|' ) ;
+				}
 			}
-		if ( draw_mode == hoof_draw_current || draw_mode == hoof_draw_cursor )
+		// draw history, the end of it that fits on the bottom row
+		output_row_start( window_height ) ;
+		text = history ;
+		if ( history_size > window_width - 1 )
 			{
-			printf( "\x1b[0m" );
+			text += history_size - ( window_width - 1 ) ;
 			}
-		}
-	void draw_everything( struct hoof * hoof, struct hoof_interface * interface , b * history )
-		{
-		// clear screen
-		printf("\x1b[2J");
-		// draw hoof state
-		hoof_draw( hoof, window_width , window_height - 1 , draw_callback , interface ) ;
-		// draw history
-		draw_callback( hoof_draw_normal , window_width - history_size, window_height , history ) ;
-		// flush
-		fflush( stdout ) ;
+		output_length += sprintf( ( char * ) output + output_length , "%s" , text ) ;
+		// send it all at once
+		return write_all( STDOUT_FILENO , output , output_length ) ;
 		}
 	void history_add_character( b * history , b character )
 		{
@@ -141,8 +296,9 @@
 		b * filename = "" ;
 		n done = 0 ;
 		struct termios old_tio , new_tio ;
-		n read_num = 0 ;
-		b ch[ 3 ] = { 0 , 0 , 0 } ;
+		b ch = 0 ;
+		n escape = 0 ;
+		n redraw = 0 ;
 		// TODO think about this
 		b punctuation = 0 ;
 		n i = 0 ;
@@ -167,9 +323,12 @@
 		tcgetattr( STDIN_FILENO , & old_tio ) ;
 		new_tio = old_tio ;
 		new_tio . c_lflag &= ( ~ ICANON & ~ ECHO ) ;
+		new_tio . c_cc[ VMIN ] = 1 ;
+		new_tio . c_cc[ VTIME ] = 0 ;
 		tcsetattr( STDIN_FILENO , TCSANOW , & new_tio ) ;
 		// setup hoof
-		rc = hoof_init( filename , & hoof ) ;
+		// save in the background so the screen doesn't freeze on big files
+		rc = hoof_init_with_options( filename , hoof_option_background , & hoof ) ;
 		if ( rc != hoof_rc_success )
 			{
 			fprintf( stderr , "error hoof_init failed %s\n" , hoof_rc_to_string( rc ) ) ;
@@ -177,6 +336,12 @@
 			goto cleanup ;
 			}
 		// setup window size signal handler
+		if ( signal_pipe_open( ) != 0 )
+			{
+			fprintf( stderr, "error pipe failed %s\n", strerror( errno ) ) ;
+			fflush( stderr ) ;
+			goto cleanup ;
+			}
 		if ( signal( SIGWINCH , signal_window_size_changed ) == SIG_ERR )
 			{
 			fprintf( stderr, "error signal failed %s\n", strerror( errno ) ) ;
@@ -185,8 +350,19 @@
 			}
 		// get window size
 		get_window_size( );
+		if ( grid_resize( ) != 0 )
+			{
+			fprintf( stderr , "error out of memory\n" ) ;
+			fflush( stderr ) ;
+			goto cleanup ;
+			}
 		// draw
-		draw_everything( hoof , & interface , history );
+		if ( draw_everything( hoof , & interface , history ) != 0 )
+			{
+			fprintf( stderr , "error write failed %s\n" , strerror( errno ) ) ;
+			fflush( stderr ) ;
+			goto cleanup ;
+			}
 		// main loop
 		while ( ! done )
 			{
@@ -196,7 +372,21 @@
 				if ( window_size_changed )
 					{
 					get_window_size( );
-					draw_everything( hoof , & interface , history );
+					// clear screen, and start over with a blank grid that size
+					printf("\x1b[2J");
+					fflush( stdout ) ;
+					if ( grid_resize( ) != 0 )
+						{
+						fprintf( stderr , "error out of memory\n" ) ;
+						fflush( stderr ) ;
+						goto cleanup ;
+						}
+					if ( draw_everything( hoof , & interface , history ) != 0 )
+						{
+						fprintf( stderr , "error write failed %s\n" , strerror( errno ) ) ;
+						fflush( stderr ) ;
+						goto cleanup ;
+						}
 					window_size_changed = 0 ;
 					}
 				// handle automatic next key punctuation thing
@@ -215,102 +405,133 @@
 					punctuation = 0;
 					break;
 					}
-				// wait a little bit for a key press
-				if ( key_available( ) )
+				// once everything that was typed is handled, draw it once and wait for more
+				if ( input_index == input_length )
 					{
-					// note : need to read 3 because some keys like up down left right come in 3 bytes
-					read_num = read( STDIN_FILENO , ch , 3 ) ;
-					if ( read_num == 1 )
+					if ( redraw )
 						{
-						// if backspace
-						if ( ch[ 0 ] == 127 )
-							{
-							if ( input_word_index > 0 )
-								{
-								input_word_index -= 1 ;
-								interface . input_word[ input_word_index ] = '\0' ;
-								history_backspace( history ) ;
-								}
-							}
-						// else if whitespace
-						else if ( ch[ 0 ] == ' ' )
-							{
-							history_add_character( history , ' ' ) ;
-							break ;
-							}
-						// TODO: puncutation, commands
-						// else if punctuation (TODO call hoof function?)
-						else if ( ch[ 0 ] == ',' || ch[ 0 ] == '.' || ch[ 0 ] == '?' || ch[ 0 ] == '!' || ch[ 0 ] == 'D' || ch[ 0 ] == 'B' || ch[ 0 ] == '\r' || ch[ 0 ] == '\n' )
+						if ( draw_everything( hoof , & interface , history ) != 0 )
 							{
-							punctuation = ch[ 0 ];
-							break ;
-							}
-						// else character
-						else if ( input_word_index < hoof_max_word_length )
-							{
-							interface . input_word[ input_word_index ] = ch[ 0 ] ;
-							input_word_index += 1 ;
-							interface . input_word[ input_word_index ] = '\0' ;
-							history_add_character( history , ch[ 0 ] ) ;
+							fprintf( stderr , "error write failed %s\n" , strerror( errno ) ) ;
+							fflush( stderr ) ;
+							goto cleanup ;
 							}
+						redraw = 0 ;
+						}
+					if ( input_wait( ) != 0 )
+						{
+						goto cleanup ;
+						}
+					continue ;
+					}
+				ch = input[ input_index ] ;
+				input_index += 1 ;
+				redraw = 1 ;
+				// keys like up down left right come as 3 bytes, escape [ and a letter
+				if ( escape > 0 || ch == 27 )
+					{
+					escape = ( escape + 1 ) % 3 ;
+					// escape and not [ wasn't a key like up, so ch is just a character
+					if ( escape == 2 && ch != '[' )
+						{
+						escape = 0 ;
+						}
+					else if ( escape != 0 )
+						{
+						continue ;
 						}
 					// only allowed to use arrow keys when youre not in the middle of typing an input word
-					else if ( read_num == 3 && interface . input_word[ 0 ] == '\0' )
+					else if ( interface . input_word[ 0 ] != '\0' )
 						{
-						// TODO: change this to special characters
-						// up
-						if ( ch[ 0 ] == 27 && ch[ 1 ] == '[' && ch[ 2 ] == 'A' )
-							{
-							history_add_character( history , 'u' ) ;
-							history_add_character( history , 'p' ) ;
-							history_add_character( history , ' ' ) ;
-							interface . input_word[ 0 ] = 'u' ;
-							interface . input_word[ 1 ] = 'p' ;
-							interface . input_word[ 2 ] = '\0' ;
-							break ;
-							}
-						// down
-						else if ( ch[ 0 ] == 27 && ch[ 1 ] == '[' && ch[ 2 ] == 'B' )
-							{
-							history_add_character( history , 'd' ) ;
-							history_add_character( history , 'o' ) ;
-							history_add_character( history , 'w' ) ;
-							history_add_character( history , 'n' ) ;
-							history_add_character( history , ' ' ) ;
-							interface . input_word[ 0 ] = 'd' ;
-							interface . input_word[ 1 ] = 'o' ;
-							interface . input_word[ 2 ] = 'w' ;
-							interface . input_word[ 3 ] = 'n' ;
-							interface . input_word[ 4 ] = '\0' ;
-							break ;
-							}
-						// right
-						else if ( ch[ 0 ] == 27 && ch[ 1 ] == '[' && ch[ 2 ] == 'C' )
-							{
-							history_add_character( history , 'i' ) ;
-							history_add_character( history , 'n' ) ;
-							history_add_character( history , ' ' ) ;
-							interface . input_word[ 0 ] = 'i' ;
-							interface . input_word[ 1 ] = 'n' ;
-							interface . input_word[ 2 ] = '\0' ;
-							break ;
-							}
-						// left
-						else if ( ch[ 0 ] == 27 && ch[ 1 ] == '[' && ch[ 2 ] == 'D' )
-							{
-							history_add_character( history , 'o' ) ;
-							history_add_character( history , 'u' ) ;
-							history_add_character( history , 't' ) ;
-							history_add_character( history , ' ' ) ;
-							interface . input_word[ 0 ] = 'o' ;
-							interface . input_word[ 1 ] = 'u' ;
-							interface . input_word[ 2 ] = 't' ;
-							interface . input_word[ 3 ] = '\0' ;
-							break ;
-							}
+						continue ;
+						}
+					// TODO: change this to special characters
+					// up
+					else if ( ch == 'A' )
+						{
+						history_add_character( history , 'u' ) ;
+						history_add_character( history , 'p' ) ;
+						history_add_character( history , ' ' ) ;
+						interface . input_word[ 0 ] = 'u' ;
+						interface . input_word[ 1 ] = 'p' ;
+						interface . input_word[ 2 ] = '\0' ;
+						break ;
+						}
+					// down
+					else if ( ch == 'B' )
+						{
+						history_add_character( history , 'd' ) ;
+						history_add_character( history , 'o' ) ;
+						history_add_character( history , 'w' ) ;
+						history_add_character( history , 'n' ) ;
+						history_add_character( history , ' ' ) ;
+						interface . input_word[ 0 ] = 'd' ;
+						interface . input_word[ 1 ] = 'o' ;
+						interface . input_word[ 2 ] = 'w' ;
+						interface . input_word[ 3 ] = 'n' ;
+						interface . input_word[ 4 ] = '\0' ;
+						break ;
 						}
-					draw_everything( hoof , & interface , history );
-					} // end if key available
+					// right
+					else if ( ch == 'C' )
+						{
+						history_add_character( history , 'i' ) ;
+						history_add_character( history , 'n' ) ;
+						history_add_character( history , ' ' ) ;
+						interface . input_word[ 0 ] = 'i' ;
+						interface . input_word[ 1 ] = 'n' ;
+						interface . input_word[ 2 ] = '\0' ;
+						break ;
+						}
+					// left
+					else if ( ch == 'D' )
+						{
+						history_add_character( history , 'o' ) ;
+						history_add_character( history , 'u' ) ;
+						history_add_character( history , 't' ) ;
+						history_add_character( history , ' ' ) ;
+						interface . input_word[ 0 ] = 'o' ;
+						interface . input_word[ 1 ] = 'u' ;
+						interface . input_word[ 2 ] = 't' ;
+						interface . input_word[ 3 ] = '\0' ;
+						break ;
+						}
+					else
+						{
+						continue ;
+						}
+					}
+				// if backspace
+				if ( ch == 127 )
+					{
+					if ( input_word_index > 0 )
+						{
+						input_word_index -= 1 ;
+						interface . input_word[ input_word_index ] = '\0' ;
+						history_backspace( history ) ;
+						}
+					}
+				// else if whitespace
+				else if ( ch == ' ' )
+					{
+					history_add_character( history , ' ' ) ;
+					break ;
+					}
+				// TODO: puncutation, commands
+				// else if punctuation (TODO call hoof function?)
+				else if ( ch == ',' || ch == '.' || ch == '?' || ch == '!' || ch == 'D' || ch == 'B' || ch == '\r' || ch == '\n' )
+					{
+					punctuation = ch;
+					break ;
+					}
+				// else character
+				else if ( input_word_index < hoof_max_word_length )
+					{
+					interface . input_word[ input_word_index ] = ch ;
+					input_word_index += 1 ;
+					interface . input_word[ input_word_index ] = '\0' ;
+					history_add_character( history , ch ) ;
+					}
 				} // end while
 			// give input to hoof
 			rc = hoof_do( hoof , & interface ) ;
@@ -342,8 +563,8 @@
 			// reset input
 			input_word_index = 0 ;
 			interface . input_word[ 0 ] = '\0' ;
-			// draw
-			draw_everything( hoof , & interface , history );
+			// draw once the rest of what was typed is handled too
+			redraw = 1 ;
 			} // end main loop
 		// make sure we print a newline so the prompt is good
 		printf( "\n" ) ;
@@ -351,6 +572,14 @@
 		// cleanup
 		cleanup:
 		hoof_free( & hoof ) ;
+		free( grid . cells ) ;
+		free( grid . dirty ) ;
+		free( output ) ;
+		if ( signal_pipe[ 0 ] != -1 )
+			{
+			close( signal_pipe[ 0 ] ) ;
+			close( signal_pipe[ 1 ] ) ;
+			}
 		tcsetattr( STDIN_FILENO , TCSANOW , & old_tio ) ;
 		return rc ;
 		}
@@ -11,6 +11,10 @@
 	#include "hoof.h"
 	#include <stdlib.h> // malloc calloc free
 	#include <stdio.h> // FILE fopen fread fwrite fclose rename remove
+	#ifdef hoof_use_threads
+		#include <pthread.h> // pthread_create pthread_join
+		#include <unistd.h> // sysconf
+	#endif
 // defines
 	#define null NULL
 	// error handling
@@ -45,6 +49,13 @@
 		#define hoof_memory_free( pointer ) \
 			hoof_hook_free( pointer ) ; \
 			pointer = null ;
+		// values and words come from a slab when hoof_option_slab is set
+		#define hoof_node_calloc( hoof , slab , pointer , pointer_type ) \
+			pointer = ( pointer_type * ) hoof_slab_take( hoof , & ( hoof ) -> slab ) ; \
+			err_if( pointer == null , hoof_rc_error_memory ) ;
+		#define hoof_node_free( hoof , slab , pointer ) \
+			hoof_slab_give( hoof , & ( hoof ) -> slab , pointer ) ; \
+			pointer = null ;
 		#ifdef hoof_use_mem_hooks
 			extern void *hoof_hook_malloc( size_t size ) ;
 			extern void *hoof_hook_calloc( size_t nmemb , size_t size ) ;
@@ -55,11 +66,11 @@
 			#define hoof_hook_free free
 		#endif
 	// file hooks
-		// note: these are just used to test file failures. we still use feof fclose and remove directly
+		// note: these are just used to test file failures. we still use feof fseek fclose and remove directly
 		#ifdef hoof_use_file_hooks
 			extern FILE *hoof_hook_fopen( const b * path , const b * mode ) ;
-			extern size_t hoof_hook_rread( void * ptr , size_t size , size_t nmemb , FILE * stream ) ;
-			extern size_t hoof_hook_rwrite( const void * ptr , size_t size , size_t nmemb , FILE * stream ) ;
+			extern size_t hoof_hook_fread( void * ptr , size_t size , size_t nmemb , FILE * stream ) ;
+			extern size_t hoof_hook_fwrite( const void * ptr , size_t size , size_t nmemb , FILE * stream ) ;
 			extern int hoof_hook_rename( const b * oldpath , const b * newpath ) ;
 		#else
 			#define hoof_hook_fopen fopen
@@ -77,28 +88,101 @@
 	// macros to make the code easier to read
 		#define hear( word ) ( hoof_words_are_same( ( b * ) word , interface->input_word ) )
 		#define say( word ) hoof_output( ( b * ) word , interface ) ;
+		#define hoof_journaling( hoof ) ( ( ( hoof ) -> options & hoof_option_journal ) && ( hoof ) -> journal_compact == 0 && ( hoof ) -> loading == 0 )
 	// misc
 		#define hoof_int_max_string         "9223372036854775807"
 		#define hoof_int_max_string_length 19
 		#define hoof_int_min_string        "-9223372036854775808"
 		#define hoof_int_min_string_length 20
+		#define hoof_hash_start 5381
+		// move and go take a count of up to this many digits, or most to go as far as they can
+		#define hoof_steps_digits_max 18
+		#define hoof_steps_most -1
+		// or page for as many values as were on the screen, which only makes sense for up and down
+		#define hoof_steps_page -2
+	// search
+		// without a search index the root page is cut in to chunks that workers scan at the same time
+		#define hoof_search_threads_max 16
+		#define hoof_search_chunks_per_thread 4
+	// sort
+		// how sort orders a page, and if the pages inside it are sorted too, the journal keeps these with the edit
+		#define hoof_sort_reverse 1
+		#define hoof_sort_all     2
+	// loading
+		// we read the file in blocks this big and pull words straight out of the block
+		#define hoof_read_buffer_size 65536
+		// what a record in a file is, the text format spells these out after new
+		#define hoof_record_right 0
+		#define hoof_record_down  1
+		#define hoof_record_in    2
+		#define hoof_record_out   3
+		// binary files start with "hoof" and its null, then the version
+		#define hoof_binary_magic "hoof"
+		#define hoof_binary_magic_length 5
+		#define hoof_binary_version 2
+		#define hoof_binary_dictionary_max 268435456
+	// saving
+		#define hoof_dictionary_capacity_initial 256
+		// we build the file up in a buffer this big and write it out each time the buffer fills
+		#define hoof_write_buffer_size 65536
+		#define hoof_saved_capacity_initial 256
+	// journal
+		// edits are appended to filename.journal until it gets this big, then save rewrites the file instead
+		#define hoof_journal_max_size 1048576
+		#define hoof_journal_suffix ".journal"
+		#define hoof_journal_suffix_length 8
+		#define hoof_journal_capacity_initial 256
+		#define hoof_journal_depth_max 1048576
+	// nodes
+		// a slab gets a block this many nodes big each time its free list runs out
+		#define hoof_slab_block_nodes 1024
+		#define hoof_intern_slots_initial 256
+		// a value's words are an array that holds 4 8 16 or 32 words, each size has its own slab
+		#define hoof_word_sizes 4
+		#define hoof_word_size_smallest 4
+	// dig
+		// with hoof_option_dig_index pages with at least this many values get a dig index, smaller ones are scanned
+		#define hoof_dig_index_min 256
 // structures
 	/*	note about the internal structure:
-		pages have a value head and value tail, both with word_head = null
+		pages have a value head and value tail, both with sentinel set
+			what only a page needs to know, like where it is in the file, is in the struct hoof_page its value head has
 		pages can not be empty, they must contain at least 1 real value
 			the head value, a real value, and the tail value
-		values have a word head and word tail, both with value = null
+			except an unloaded page, which is only a head and tail until hoof_page_load builds it
+		values keep their words in an array, words[ 0 ] to words[ word_count - 1 ]
 		values can be empty
-			empty value is only word head and word tail
+			empty value has a word_count of 0, and words may be null
 		current_value will never be a value head or value tail
-		current_word may be a value head or a real word
+		current_word is an index in to current_value's words
+			-1 is before the first word and word_count is after the last one
+			it's only -1 while digging, and only word_count when the value is empty or we're adding words at the end
 		root is the value head of the root page
+		with hoof_option_search_index every intern has a posting for each value that has the word
+			hoof_word_add hoof_word_delete and hoof_value_clear keep the postings in step
+		every page also keeps its real values in a treap, so a value's position and the value at a position take O(log n)
+			hoof_value_link and hoof_value_unlink keep the page and its treap in step
+		a page is dirty once it's different from the file on disk, or something inside it is
+			hoof_value_link hoof_value_unlink hoof_word_add hoof_word_delete and hoof_value_clear mark it
 		*/
-	struct hoof_word
+	struct hoof_intern
+	{
+		struct hoof_intern * next ; // next text in the same slot
+		n hash ;
+		n count ; // how many words use this text
+		struct hoof_posting * postings ; // values with this word, only with hoof_option_search_index
+		n posting_count ;
+		b length ;
+		b keyword ; // done pause or literal, which need literal in front of them in the text format
+		b text[ hoof_max_word_length + 1 ] ;
+	} ;
+	struct hoof_page
 	{
-		struct hoof_word * left ;
-		struct hoof_word * right ;
-		b * value ; // bad name, need to be changed
+		struct hoof_dig_index * dig_index ; // null until dig needs it and again after the page changes
+		n offset ; // where the page starts in the file on disk + 1, 0 if it isn't in one piece there
+		n length ; // how many bytes of the file the page is, 0 if we don't know
+		b unloaded ; // the page is still only in the file, hoof_page_load builds it
+		b dirty ; // the page or a page inside it changed since the file was written
 	} ;
 	struct hoof_value
 	{
@@ -106,22 +190,220 @@
 		struct hoof_value * down ;
 		struct hoof_value * in ;
 		struct hoof_value * out ;
-		struct hoof_word * word_head ;
+		struct hoof_intern * * words ; // text of each word, every word with the same text shares it
+		struct hoof_page * page ; // page heads only, null for every other value
+		struct hoof_value * index_parent ; // the page's values are also in a treap ordered like the page, the root's parent is the page head
+		struct hoof_value * index_left ; // page heads keep the root of the treap here
+		struct hoof_value * index_right ;
+		n index_size ; // how many values are in this part of the treap
+		n index_priority ;
+		struct hoof_posting * postings ; // words this value has, only with hoof_option_search_index
+		n layout_columns ; // how wide the screen was when the value was last laid out, 0 if its words changed since
+		n layout_rows ; // how many rows the value takes on a screen that wide
+		b word_count ; // at most hoof_max_value_length
+		b word_capacity ; // at most 32, the biggest words array
+		b sentinel ; // value heads and tails of pages have no words
+	} ;
+	struct hoof_posting
+	{
+		struct hoof_value * value ;
+		struct hoof_intern * word ;
+		n count ; // how many times the value has the word
+		struct hoof_posting * next ; // other values with the same word
+		struct hoof_posting * previous ;
+		struct hoof_posting * next_word ; // other words of the same value
+	} ;
+	struct hoof_search_chunk
+	{
+		struct hoof_value * start ; // first root value of the chunk
+		struct hoof_value * stop ; // first root value of the next chunk, null for the last chunk
+		struct hoof_value * * values ; // where the chunk's part of the search results starts
+		n count ; // how many values the chunk has with the words
+	} ;
+	struct hoof_search_worker
+	{
+		struct hoof_search_chunk * chunks ;
+		n chunk_count ;
+		n first ; // a worker scans chunks first, first + step, first + step * 2 and so on
+		n step ;
+		struct hoof_intern * * words ;
+		n word_count ;
+		n fill ; // 0 while only counting what each chunk finds, 1 once its values have room for them
+	} ;
+	struct hoof_drawer
+	{
+		hoof_draw_function draw_function ; // null while we're only hashing the rows
+		n * hashes ; // what's drawn on each row, null to draw every row
+		n * previous ; // hashes of the last frame, rows with the same hash aren't drawn, null to draw every row
+		n rows ;
+		struct hoof_cell * cells ; // draw in to these instead of calling draw_function, null to call it
+		n columns ;
+	} ;
+	struct hoof_dig_node
+	{
+		struct hoof_intern * word ; // last word of the words this node is for
+		n parent ; // node for the words before that one, -1 for the root which is no words
+		n next ; // next node in the same slot, -1 for none
+		n first ; // where the positions of the values that start with this node's words are
+		n count ;
+		n exact ; // where the positions of the values that are exactly this node's words are
+		n exact_count ;
+	} ;
+	struct hoof_dig_index
+	{
+		struct hoof_value * page ;
+		struct hoof_dig_index * next ; // every dig index hoof has is in a list, so hoof_free can find them
+		struct hoof_dig_index * previous ;
+		struct hoof_dig_node * nodes ; // a trie of the words values start with, node 0 is the root
+		n node_count ;
+		n * slots ; // hash table of parent and word to node
+		n slot_count ;
+		n * positions ; // positions in the page, in page order for each node
+		struct hoof_value * * values ; // the page's values by position when the index was built
+	} ;
+	struct hoof_slab_free
+	{
+		struct hoof_slab_free * next ;
+	} ;
+	union hoof_slab_block
+	{
+		union hoof_slab_block * next ; // blocks are kept in a list so they can all be freed at once
+		n align ; // nodes start right after this, so it has to be aligned for them
+	} ;
+	struct hoof_slab
+	{
+		n size ; // how big each node is
+		struct hoof_slab_free * free ; // nodes that were given back
+		union hoof_slab_block * blocks ;
+		n left ; // nodes in the newest block that haven't been handed out yet
+	} ;
+	struct hoof_reader
+	{
+		FILE * fp ;
+		b * buffer ;
+		n size ; // how many bytes of buffer are filled
+		n index ; // next byte to tokenize
+		n offset ; // where in the file buffer starts
+		n hash ; // hash of everything read so far
+	} ;
+	struct hoof_builder
+	{
+		struct hoof * hoof ;
+		struct hoof_value * value ; // value words are added to
+		n lazy ; // leave pages unloaded
+		n skip ; // how deep we are inside a page we're leaving unloaded
+		n offset ; // where in the file the current record starts
+		n depth ; // how many pages in from where we started
+		n page ; // only loading one page
+		n finished ; // came back out of the page we were loading
+		n replay ; // the file has something hoof_save never writes, so its words have to go through hoof_do
+	} ;
+	struct hoof_dictionary
+	{
+		b * * words ; // distinct words in the order they were first seen
+		n count ;
+		n capacity ;
+		n * slots ; // hash table of index + 1 into words, 0 is an empty slot
+		n slot_count ;
+	} ;
+	struct hoof_saved
+	{
+		struct hoof_value * page ;
+		n offset ; // where the page is in the new file
+		n length ;
+		n parent ; // index of the page this one is inside of, -1 for the root page
+	} ;
+	struct hoof_writer
+	{
+		FILE * fp ; // null when the whole file is kept in buffer
+		b * buffer ;
+		n size ; // how big buffer is
+		n used ; // how many bytes of buffer are filled
+		n binary ;
+		n collecting ; // the first pass of a binary save only fills in the dictionary
+		struct hoof_dictionary dictionary ;
+		n length ; // how many bytes have been written
+		n hash ; // hash of everything written so far
+		FILE * source ; // the file being replaced, pages that haven't changed are copied from it
+		n copying ; // the first pass found a page to copy
+		struct hoof_saved * saved ; // where pages end up in the new file
+		n saved_count ;
+		n saved_capacity ;
+		n open ; // index in saved of the page being written, -1 for the root page
 	} ;
 	struct hoof
 	{
 		b * filename ;
-		// TODO: when we switch to a new file format, we can get rid of loading
-		n loading ;
+		n options ;
+		n binary ; // save in the binary format
+		n file_binary ; // the file on disk is in the binary format, unloaded pages are read with this
+		struct hoof_intern * * dictionary ; // words of a binary file, each counts as a word using its intern, unloaded pages and pages copied on save use them
+		n dictionary_count ;
+		n base_length ; // length and hash of the file when it was loaded or last rewritten
+		n base_hash ;
+		b * journal ; // edits since the last save
+		n journal_length ;
+		n journal_capacity ;
+		n journal_size ; // bytes in the journal file, 0 if it has to be started over
+		n journal_compact ; // the next save has to rewrite the whole file
+		n modified ; // something changed that isn't in the file or journal yet
+		n loading ; // hoof_do is hearing the words of a file that hoof_load_text couldn't build
+		n building ; // the loader is making values that are already in the file, so their pages stay clean
+		n copy_pages ; // offsets of pages match the file on disk, so save can copy clean pages from it
+		b * save_buffer ; // a saved file that hasn't finished being written yet
+		n save_length ;
+		FILE * save_fp ; // the temp file save_buffer goes in to, opened before the save thread starts
+		n save_rc ;
+		n save_threaded ;
+		#ifdef hoof_use_threads
+			pthread_t save_thread ;
+		#endif
+		struct hoof_slab value_slab ;
+		struct hoof_slab word_slabs[ hoof_word_sizes ] ;
+		struct hoof_slab intern_slab ;
+		struct hoof_slab posting_slab ;
+		struct hoof_slab page_slab ;
+		struct hoof_intern * * interns ; // hash table of the text of every word in the tree
+		n intern_slot_count ;
+		n intern_count ;
+		n index_seed ; // where the priorities of new treap nodes come from
+		struct hoof_dig_index * dig_indexes ;
+		struct hoof_value * * dig_candidates ; // values from the current value down that can still match the dig, in page order
+		n dig_candidate_count ;
+		n dig_candidate_capacity ;
+		n dig_candidate_words ; // how many words of the dig every candidate is known to match, -1 until dig needs candidates
+		b search_words[ hoof_max_value_length ][ hoof_max_word_length + 1 ] ; // what the last search was for
+		n search_word_count ;
+		struct hoof_value * * search_results ; // values with the search words, in the order they are in the hierarchy
+		n search_result_count ;
+		n search_result_capacity ;
+		n search_stale ; // the hierarchy changed since the results were found
+		n some_unloaded ; // a page may still be unloaded, so search has to load pages first
+		n sort_mode ; // what sort has heard so far, hoof_sort_reverse and hoof_sort_all
 		n paused ;
 		n literal ;
 		n ( * state )( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
 		struct hoof_value * root ;
 		struct hoof_value * current_value ;
-		struct hoof_word * current_word ;
+		n current_word ;
+		n steps ; // how far move or go goes, hoof_steps_most for as far as it can, hoof_steps_page for a screenful
+		n view_first ; // position in its page of the first value on the screen the last time it was drawn
+		n view_count ; // how many values were on the screen, go page goes this far, 0 until the current page is drawn
+		n * draw_hashes ; // what hoof_draw_changed drew on each row last time
+		n * draw_next ; // where hoof_draw_changed hashes the new frame before it swaps it with draw_hashes
+		n draw_rows ;
+		n draw_columns ;
+		n draw_valid ; // draw_hashes are what's on the screen
+		struct hoof_cell * grid_cells ; // hoof_draw_grid draws the frame here, then copies the rows that changed to the client's grid
+		n grid_capacity ;
 	} ;
 // static function prototypes
 	static n hoof_words_are_same( b * word_1 , b * word_2 ) ;
+	static n hoof_word_hash( b * word ) ;
+	static n hoof_hash_bytes( n hash , b * bytes , n count ) ;
+	static n hoof_number_text( n number , b * text ) ;
+	static n hoof_word_steps( b * word , n * steps ) ;
+	static n hoof_steps_to( struct hoof * hoof , n from , n direction , n last ) ;
 	// states
 		static n hoof_state_navigate( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
 		static n hoof_state_most_choice( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
@@ -129,15 +411,138 @@
 		static n hoof_state_new( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
 		static n hoof_state_delete_choice( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
 		static n hoof_state_move_choice( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
+		static n hoof_state_go_choice( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
 		static n hoof_state_dig( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
+		static n hoof_state_search( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
+		static n hoof_state_sort_choice( struct hoof * hoof , struct hoof_interface * interface , n * huh ) ;
 	// loading and saving
+		static n hoof_reader_fill( struct hoof_reader * reader ) ;
+		static n hoof_reader_word( struct hoof_reader * reader , b * word , n * done ) ;
+		static n hoof_reader_byte( struct hoof_reader * reader , b * byte , n * done ) ;
+		static n hoof_reader_number( struct hoof_reader * reader , n * number , n * done ) ;
+		static n hoof_build_value( struct hoof_builder * builder , n record ) ;
+		static n hoof_build_word( struct hoof_builder * builder , b * word ) ;
+		static void hoof_build_backspace( struct hoof_builder * builder ) ;
+		static void hoof_build_out( struct hoof_builder * builder , n end ) ;
 		static n hoof_load( struct hoof * hoof ) ;
-		static n hoof_save_word( FILE * fp , b * word , n newline ) ;
-		static n hoof_save_value( FILE * fp , struct hoof_value * value , b * direction ) ;
+		static n hoof_page_load( struct hoof * hoof , struct hoof_value * value ) ;
+		static n hoof_load_text( struct hoof_reader * reader , struct hoof_builder * builder ) ;
+		static n hoof_load_replay( struct hoof * hoof , struct hoof_reader * reader ) ;
+		static n hoof_load_binary( struct hoof * hoof , struct hoof_reader * reader , struct hoof_builder * builder ) ;
+		static n hoof_load_records( struct hoof_reader * reader , struct hoof_builder * builder , struct hoof_intern * * words , n count ) ;
+		static n hoof_dictionary_grow( struct hoof_dictionary * dictionary ) ;
+		static n hoof_dictionary_slot( struct hoof_dictionary * dictionary , b * word ) ;
+		static n hoof_dictionary_add( struct hoof_dictionary * dictionary , b * word ) ;
+		static void hoof_dictionary_free( struct hoof * hoof , struct hoof_intern * * * dictionary_F , n count ) ;
+		static n hoof_save_flush( struct hoof_writer * writer ) ;
+		static n hoof_save_reserve( struct hoof_writer * writer , n count ) ;
+		static n hoof_save_bytes( struct hoof_writer * writer , b * bytes , n count ) ;
+		static n hoof_save_number( struct hoof_writer * writer , n number ) ;
+		static n hoof_save_word( struct hoof_writer * writer , b * word , n newline ) ;
+		static n hoof_save_value( struct hoof_writer * writer , struct hoof_value * value , n record ) ;
+		static n hoof_save_out( struct hoof_writer * writer ) ;
+		static void hoof_page_dirty( struct hoof * hoof , struct hoof_value * owner ) ;
+		static n hoof_save_record( struct hoof_writer * writer , struct hoof_value * page , n offset , n length ) ;
+		static n hoof_save_open( struct hoof_writer * writer , struct hoof_value * page ) ;
+		static void hoof_save_close( struct hoof_writer * writer ) ;
+		static n hoof_save_shift( struct hoof_writer * writer , struct hoof_value * page , n delta ) ;
+		static n hoof_save_copy( struct hoof_writer * writer , struct hoof_value * page , n * copied ) ;
+		static n hoof_save_seed( struct hoof * hoof , struct hoof_writer * writer ) ;
+		static n hoof_save_dictionary( struct hoof * hoof , struct hoof_writer * writer , struct hoof_intern * * * dictionary ) ;
+		static void hoof_save_apply( struct hoof_writer * writer ) ;
+		static n hoof_save_walk( struct hoof * hoof , struct hoof_writer * writer ) ;
+		static n hoof_save_contents( struct hoof * hoof , struct hoof_writer * writer ) ;
+		static void hoof_save_filename( struct hoof * hoof , b * temp_filename ) ;
+		static n hoof_save_write( struct hoof * hoof ) ;
+		#ifdef hoof_use_threads
+			static void * hoof_save_thread( void * hoof ) ;
+		#endif
+		static n hoof_save_start( struct hoof * hoof ) ;
+		static n hoof_save_wait( struct hoof * hoof ) ;
 		static n hoof_save( struct hoof  *hoof ) ;
+	// journal
+		static void hoof_journal_filename( struct hoof * hoof , b * journal_filename ) ;
+		static n hoof_journal_add( struct hoof * hoof , b * bytes , n count ) ;
+		static n hoof_journal_text( struct hoof * hoof , b * text ) ;
+		static n hoof_journal_number( struct hoof * hoof , n number ) ;
+		static n hoof_journal_path( struct hoof * hoof , struct hoof_value * value ) ;
+		static void hoof_journal_end( struct hoof * hoof ) ;
+		static n hoof_journal_value_edit( struct hoof * hoof , b * op , struct hoof_value * value ) ;
+		static n hoof_journal_word_edit( struct hoof * hoof , b * op , struct hoof_value * value , n index ) ;
+		static n hoof_journal_save( struct hoof * hoof ) ;
+		static n hoof_journal_load( struct hoof * hoof ) ;
+		static n hoof_journal_read_word( struct hoof_reader * reader , b * word , n * done ) ;
+		static n hoof_journal_read_number( struct hoof_reader * reader , n * number , n * done ) ;
+		static n hoof_journal_read_path( struct hoof_reader * reader , n * * path_A , n * depth , n * done ) ;
+		static n hoof_journal_find( struct hoof * hoof , n * path , n depth , struct hoof_value * * parent , struct hoof_value * * value ) ;
+		static n hoof_journal_place( struct hoof * hoof , struct hoof_value * parent , n index , n create_empty , struct hoof_value * * before ) ;
+		static n hoof_journal_replay( struct hoof * hoof , struct hoof_reader * reader , b * op , n * done ) ;
+	// nodes
+		static void hoof_slab_init( struct hoof_slab * slab , n size ) ;
+		static void * hoof_slab_take( struct hoof * hoof , struct hoof_slab * slab ) ;
+		static void hoof_slab_give( struct hoof * hoof , struct hoof_slab * slab , void * node ) ;
+		static void hoof_slab_release( struct hoof_slab * slab ) ;
+		static struct hoof_intern * hoof_intern_find( struct hoof * hoof , b * text ) ;
+		static n hoof_intern_grow( struct hoof * hoof ) ;
+		static n hoof_intern_add( struct hoof * hoof , b * text , struct hoof_intern * * intern ) ;
+		static void hoof_intern_release( struct hoof * hoof , struct hoof_intern * intern ) ;
+		static n hoof_words_size( n capacity ) ;
+		static n hoof_words_reserve( struct hoof * hoof , struct hoof_value * value , n count ) ;
+		static void hoof_words_free( struct hoof * hoof , struct hoof_value * value ) ;
+		static void hoof_value_free( struct hoof * hoof , struct hoof_value * value ) ;
+		static void hoof_page_free( struct hoof * hoof , struct hoof_value * * page_F ) ;
+	// index
+		static n hoof_index_size( struct hoof_value * node ) ;
+		static struct hoof_value * hoof_index_first( struct hoof_value * node ) ;
+		static void hoof_index_rotate( struct hoof_value * node ) ;
+		static void hoof_index_add( struct hoof * hoof , struct hoof_value * value ) ;
+		static void hoof_index_remove( struct hoof_value * value ) ;
+		static n hoof_index_of( struct hoof_value * value ) ;
+		static struct hoof_value * hoof_index_page( struct hoof_value * value ) ;
+		static n hoof_index_count( struct hoof_value * page ) ;
+		static struct hoof_value * hoof_index_value( struct hoof_value * page , n index ) ;
+		static void hoof_value_link( struct hoof * hoof , struct hoof_value * value , struct hoof_value * before ) ;
+		static void hoof_value_unlink( struct hoof * hoof , struct hoof_value * value ) ;
+	// dig index
+		static n hoof_dig_index_child( struct hoof_dig_index * index , n parent , struct hoof_intern * word ) ;
+		static n hoof_dig_index_add( struct hoof_dig_index * index , n parent , struct hoof_intern * word ) ;
+		static n hoof_dig_index_build( struct hoof * hoof , struct hoof_value * page ) ;
+		static void hoof_dig_index_free( struct hoof * hoof , struct hoof_value * page ) ;
+		static n hoof_dig_index_search( struct hoof * hoof , struct hoof_intern * intern , n exact ) ;
+	// dig candidates
+		static n hoof_dig_candidates_start( struct hoof * hoof ) ;
+		static n hoof_dig_candidates_narrow( struct hoof * hoof , struct hoof_intern * intern , n exact ) ;
+	// search
+		static n hoof_posting_add( struct hoof * hoof , struct hoof_value * value , struct hoof_intern * word ) ;
+		static void hoof_posting_remove( struct hoof * hoof , struct hoof_value * value , struct hoof_intern * word ) ;
+		static struct hoof_value * hoof_tree_next( struct hoof_value * value ) ;
+		static n hoof_tree_before( struct hoof_value * value_1 , struct hoof_value * value_2 ) ;
+		static n hoof_values_sort( struct hoof_value * * values , n count , n ( * before )( struct hoof_value * value_1 , struct hoof_value * value_2 ) ) ;
+		static void hoof_search_word( struct hoof * hoof , b * word , n * huh ) ;
+		static n hoof_search_has( struct hoof_value * value , struct hoof_intern * * words , n count ) ;
+		static n hoof_search_reserve( struct hoof * hoof , n count ) ;
+		static n hoof_search_load( struct hoof * hoof ) ;
+		static void hoof_search_chunk( struct hoof_search_worker * worker , struct hoof_search_chunk * chunk ) ;
+		static void hoof_search_work( struct hoof_search_worker * worker ) ;
+		#ifdef hoof_use_threads
+			static void * hoof_search_thread( void * worker ) ;
+		#endif
+		static void hoof_search_run( struct hoof_search_worker * workers , n worker_count ) ;
+		static n hoof_search_scan( struct hoof * hoof , struct hoof_intern * * words ) ;
+		static n hoof_search_find( struct hoof * hoof ) ;
+		static n hoof_search_step( struct hoof * hoof , n direction , n * found ) ;
+	// sort
+		static n hoof_sort_words_compare( struct hoof_intern * word_1 , struct hoof_intern * word_2 ) ;
+		static n hoof_sort_compare( struct hoof_value * value_1 , struct hoof_value * value_2 ) ;
+		static void hoof_sort_page( struct hoof * hoof , struct hoof_value * page , n reverse ) ;
+		static n hoof_sort_load( struct hoof * hoof , struct hoof_value * page ) ;
+		static n hoof_sort( struct hoof * hoof , struct hoof_value * value , n mode ) ;
 	// drawing
 		static n hoof_word_length( b * word ) ;
-		static void hoof_draw_value( struct hoof * hoof , hoof_draw_function draw_function , struct hoof_value * value , n max_columns , n row , n * row_size , struct hoof_interface * hoof_interface ) ;
+		static void hoof_draw_text( struct hoof_drawer * drawer , n draw_mode , n column , n row , b * text ) ;
+		static n hoof_draw_unchanged( struct hoof_drawer * drawer , n row , n count ) ;
+		static void hoof_draw_value( struct hoof * hoof , struct hoof_drawer * drawer , struct hoof_value * value , n max_columns , n row , n * row_size , struct hoof_interface * hoof_interface ) ;
+		static void hoof_draw_frame( struct hoof * hoof , struct hoof_drawer * drawer , n max_columns , n max_rows , struct hoof_interface * hoof_interface ) ;
 	static void hoof_output( const b * what_to_output, struct hoof_interface *interface ) ;
 	static n hoof_word_verify( b *word ) ;
 	static n hoof_strdup( b *word_in, b **word_out_A ) ;
@@ -146,12 +551,13 @@
 	static void hoof_most_up( struct hoof *hoof ) ;
 	static void hoof_most_down( struct hoof *hoof ) ;
 	static void hoof_most_out( struct hoof *hoof ) ;
-	static void hoof_most_in( struct hoof *hoof ) ;
+	static n hoof_most_in( struct hoof *hoof ) ;
 	static n hoof_word_insert( struct hoof *hoof, b *value ) ;
-	static n hoof_value_insert( struct hoof_value *before ) ;
-	static n hoof_page_init( struct hoof_value *parent, n create_empty_value, struct hoof_value **page_A ) ;
+	static n hoof_word_add( struct hoof * hoof , struct hoof_value * value , n index , b * text ) ;
+	static n hoof_value_insert( struct hoof *hoof, struct hoof_value *before ) ;
+	static n hoof_page_init( struct hoof *hoof, struct hoof_value *parent, n create_empty_value, struct hoof_value **page_A ) ;
 	static void hoof_value_clear( struct hoof *hoof, struct hoof_value *value ) ;
-	static void hoof_word_delete( struct hoof *hoof, struct hoof_word *word_to_delete ) ;
+	static void hoof_word_delete( struct hoof *hoof, struct hoof_value *value, n index ) ;
 	static void hoof_value_delete( struct hoof *hoof, struct hoof_interface *interface ) ;
 	static void hoof_page_delete( struct hoof *hoof, struct hoof_value **page_F ) ;
 	static void hoof_dig( struct hoof *hoof, b *word ) ;
@@ -169,13 +575,122 @@
 			}
 		return 1 ;
 		}
+	static n hoof_word_hash( b * word )
+		{
+		n hash = 5381 ;
+		while ( ( * word ) != '\0' )
+			{
+			// masking keeps the multiply from ever overflowing
+			hash = ( ( hash * 33 ) ^ ( * word ) ) & 0xffffffffff ;
+			word += 1 ;
+			}
+		return hash ;
+		}
+	static n hoof_hash_bytes( n hash , b * bytes , n count )
+		{
+		n i = 0 ;
+		for ( i = 0 ; i < count ; i += 1 )
+			{
+			hash = ( ( hash * 33 ) ^ bytes[ i ] ) & 0xffffffffff ;
+			}
+		return hash ;
+		}
+	static n hoof_number_text( n number , b * text )
+		{
+		/*!	\brief Writes a number that isn't negative as decimal digits.
+			\param[in] number Number to write.
+			\param[out] text Gets the digits, needs room for 19. Not null terminated.
+			\return how many digits were written
+			*/
+		// data
+		n length = 0 ;
+		n i = 0 ;
+		b digit = 0 ;
+		// code
+		do
+			{
+			text[ length ] = ( b ) ( '0' + number % 10 ) ;
+			length += 1 ;
+			number /= 10 ;
+			}
+		while ( number > 0 ) ;
+		// the digits came out backwards
+		for ( i = 0 ; i < length / 2 ; i += 1 )
+			{
+			digit = text[ i ] ;
+			text[ i ] = text[ length - 1 - i ] ;
+			text[ length - 1 - i ] = digit ;
+			}
+		return length ;
+		}
+	static n hoof_word_steps( b * word , n * steps )
+		{
+		/*!	\brief Reads a count for move or go.
+			\param[in] word The word.
+			\param[out] steps Gets the count, only if word is one.
+			\return 1 if word is a number bigger than 0
+			*/
+		// data
+		n number = 0 ;
+		n i = 0 ;
+		// code
+		for ( i = 0 ; word[ i ] != '\0' ; i += 1 )
+			{
+			if ( word[ i ] < '0' || word[ i ] > '9' || i == hoof_steps_digits_max )
+				{
+				return 0 ;
+				}
+			number = number * 10 + ( word[ i ] - '0' ) ;
+			}
+		if ( number == 0 )
+			{
+			return 0 ;
+			}
+		( * steps ) = number ;
+		return 1 ;
+		}
+	static n hoof_steps_to( struct hoof * hoof , n from , n direction , n last )
+		{
+		/*!	\brief Where a move or go of hoof->steps ends up, stopping at the edge.
+			\param[in] hoof struct hoof context.
+			\param[in] from Where it starts.
+			\param[in] direction -1 toward 0, 1 toward last.
+			\param[in] last The furthest it can go.
+			\return where it ends up
+			*/
+		// data
+		n steps = hoof -> steps ;
+		// code
+		// a screenful, so the values after the ones on the screen are on it next
+		if ( steps == hoof_steps_page )
+			{
+			steps = hoof -> view_count > 1 ? hoof -> view_count : 1 ;
+			}
+		if ( direction < 0 )
+			{
+			if ( steps == hoof_steps_most || steps >= from )
+				{
+				return 0 ;
+				}
+			return from - steps ;
+			}
+		if ( steps == hoof_steps_most || steps >= last - from )
+			{
+			return last ;
+			}
+		return from + steps ;
+		}
 	// states
 		static n hoof_state_navigate( struct hoof *hoof, struct hoof_interface *interface, n *huh )
 			{
 			/* DATA */
 			n rc = hoof_rc_success;
 
-			struct hoof_word *read_word = null;
+			n i = 0;
+			n found = 0;
+
+			b count[ hoof_int_max_string_length + 1 ];
+			b position[ hoof_int_max_string_length + 1 ];
 
 
 			/* CODE */
@@ -184,6 +699,7 @@
 				err_if( hoof->loading, hoof_rc_error_file_bad );
 
 				err_passthrough( hoof_save( hoof ) );
+				err_passthrough( hoof_save_wait( hoof ) );
 				say( "goodbye" );
 				rc = hoof_rc_quit;
 			}
@@ -193,32 +709,30 @@
 			}
 			else if ( hear( "left" ) )
 			{
-				paranoid_err_if( hoof->current_word->left == null );
-				if ( hoof->current_word->left->value == null )
+				paranoid_err_if( hoof->current_word < 0 );
+				if ( hoof->current_word <= 0 )
 				{
 					say( "edge" );
 					goto cleanup;
 				}
 
-				hoof->current_word = hoof->current_word->left;
+				hoof->current_word -= 1;
 				say( "ok" );
 			}	
 			else if ( hear( "right" ) )
 			{
-				if (    hoof->current_word->right == null
-					 || hoof->current_word->right->value == null
-				   )
+				if ( hoof->current_word + 1 >= hoof->current_value->word_count )
 				{
 					say( "edge" );
 					goto cleanup;
 				}
 
-				hoof->current_word = hoof->current_word->right;
+				hoof->current_word += 1;
 				say( "ok" );
 			}	
 			else if ( hear( "up" ) )
 			{
-				if ( hoof->current_value->up->word_head == null )
+				if ( hoof->current_value->up->sentinel )
 				{
 					say( "edge" );
 					goto cleanup;
@@ -229,7 +743,7 @@
 			}	
 			else if ( hear( "down" ) )
 			{
-				if ( hoof->current_value->down->word_head == null )
+				if ( hoof->current_value->down->sentinel )
 				{
 					say( "edge" );
 					goto cleanup;
@@ -246,6 +760,8 @@
 					goto cleanup;
 				}
 
+				err_passthrough( hoof_page_load( hoof, hoof->current_value ) );
+
 				hoof_make_current_value( hoof, hoof->current_value->in->down );
 				say( "ok" );
 			}	
@@ -276,42 +792,60 @@
 			}
 			else if ( hear( "clear" ) )
 			{
+				err_passthrough( hoof_journal_value_edit( hoof, ( b * ) "clear", hoof->current_value ) );
+
 				hoof_value_clear( hoof, hoof->current_value );
 
 				say( "ok" );
 			}
 			else if ( hear( "word" ) )
 			{
-				if ( hoof->current_word->value == null )
+				if ( hoof->current_word >= hoof->current_value->word_count )
 				{
 					say( "empty" );
 				}
 				else
 				{
 					say( "ok" );
-					say( hoof->current_word->value );
+					say( hoof->current_value->words[ hoof->current_word ]->text );
 				}
 				hoof->state = hoof_state_navigate;
 			}
 			else if ( hear( "value" ) )
 			{
-				read_word = hoof->current_value->word_head->right;
-
-				if ( read_word->value == null )
+				if ( hoof->current_value->word_count == 0 )
 				{
 					say( "empty" );
 				}
 				else
 				{
 					say( "ok" );
-					while ( read_word->value != null )
+					for ( i = 0; i < hoof->current_value->word_count; i += 1 )
 					{
-						say( read_word->value );
-						read_word = read_word->right;
+						say( hoof->current_value->words[ i ]->text );
 					}
 				}
 				hoof->state = hoof_state_navigate;
 			}
+			else if ( hear( "count" ) )
+			{
+				/* values keep their word count, so this doesn't walk the words */
+				count[ hoof_number_text( hoof->current_value->word_count, count ) ] = '\0';
+
+				say( "ok" );
+				say( count );
+			}
+			else if ( hear( "where" ) )
+			{
+				/* the page's treap knows where the value is and how many values there are */
+				position[ hoof_number_text( hoof_index_of( hoof->current_value ) + 1, position ) ] = '\0';
+				count[ hoof_number_text( hoof_index_count( hoof_index_page( hoof->current_value ) ), count ) ] = '\0';
+
+				say( "ok" );
+				say( position );
+				say( "of" );
+				say( count );
+			}
 			else if ( hear( "most" ) )
 			{
 				hoof->state = hoof_state_most_choice;
@@ -326,14 +860,53 @@
 			}
 			else if ( hear( "move" ) )
 			{
+				hoof->steps = 1;
 				hoof->state = hoof_state_move_choice;
 			}
+			else if ( hear( "go" ) )
+			{
+				hoof->steps = 1;
+				hoof->state = hoof_state_go_choice;
+			}
 			else if ( hear( "dig" ) )
 			{
-				hoof->current_word = hoof->current_value->word_head;
+				hoof->current_word = -1;
+				hoof->dig_candidate_words = -1;
 
 				hoof->state = hoof_state_dig;
 			}
+			else if ( hear( "search" ) )
+			{
+				hoof->search_word_count = 0;
+
+				hoof->state = hoof_state_search;
+			}
+			else if ( hear( "next" ) || hear( "previous" ) )
+			{
+				/* there's nothing to go to until something has been searched for */
+				if ( hoof->search_word_count == 0 )
+				{
+					(*huh) = 1;
+					goto cleanup;
+				}
+
+				err_passthrough( hoof_search_step( hoof, hear( "next" ) ? 1 : -1, &found ) );
+
+				if ( found )
+				{
+					say( "ok" );
+				}
+				else
+				{
+					say( "edge" );
+				}
+			}
+			else if ( hear( "sort" ) )
+			{
+				hoof->sort_mode = 0;
+
+				hoof->state = hoof_state_sort_choice;
+			}
 			else
 			{
 				(*huh) = 1;
@@ -359,9 +932,9 @@
 			}
 			else if ( hear( "left" ) )
 			{
-				while ( hoof->current_word->left->value != null )
+				if ( hoof->current_word > 0 )
 				{
-					hoof->current_word = hoof->current_word->left;
+					hoof->current_word = 0;
 				}
 
 				hoof->state = hoof_state_navigate;
@@ -369,11 +942,9 @@
 			}
 			else if ( hear( "right" ) )
 			{
-				while (    hoof->current_word->right != null
-						&& hoof->current_word->right->value != null
-					  )
+				if ( hoof->current_word < hoof->current_value->word_count - 1 )
 				{
-					hoof->current_word = hoof->current_word->right;
+					hoof->current_word = hoof->current_value->word_count - 1;
 				}
 
 				hoof->state = hoof_state_navigate;
@@ -395,7 +966,7 @@
 			}
 			else if ( hear( "in" ) )
 			{
-				hoof_most_in( hoof );
+				err_passthrough( hoof_most_in( hoof ) );
 
 				hoof->state = hoof_state_navigate;
 				say( "ok" );
@@ -414,7 +985,7 @@
 
 
 			/* CLEANUP */
-			/* cleanup: */
+			cleanup:
 
 			return rc;
 			}
@@ -438,28 +1009,32 @@
 			}	
 			else if ( hear( "right" ) )
 			{
-				if ( hoof->current_word->right != null )
+				if ( hoof->current_word < hoof->current_value->word_count )
 				{
-					hoof->current_word = hoof->current_word->right;
+					hoof->current_word += 1;
 				}
 				hoof->state = hoof_state_new;
 				say( "new" );
 			}	
 			else if ( hear( "up" ) )
 			{
-				err_passthrough( hoof_value_insert( hoof->current_value->up ) );
+				err_passthrough( hoof_value_insert( hoof, hoof->current_value->up ) );
 
 				hoof_make_current_value( hoof, hoof->current_value->up );
 
+				err_passthrough( hoof_journal_value_edit( hoof, ( b * ) "value", hoof->current_value ) );
+
 				hoof->state = hoof_state_new;
 				say( "new" );
 			}	
 			else if ( hear( "down" ) )
 			{
-				err_passthrough( hoof_value_insert( hoof->current_value ) );
+				err_passthrough( hoof_value_insert( hoof, hoof->current_value ) );
 
 				hoof_make_current_value( hoof, hoof->current_value->down );
 
+				err_passthrough( hoof_journal_value_edit( hoof, ( b * ) "value", hoof->current_value ) );
+
 				hoof->state = hoof_state_new;
 				say( "new" );
 			}	
@@ -467,15 +1042,18 @@
 			{
 				if ( hoof->current_value->in == null )
 				{
-					err_passthrough( hoof_page_init( hoof->current_value, 1, null ) );
+					err_passthrough( hoof_page_init( hoof, hoof->current_value, 1, null ) );
 				}
 				else
 				{
-					err_passthrough( hoof_value_insert( hoof->current_value->in ) );
+					err_passthrough( hoof_page_load( hoof, hoof->current_value ) );
+					err_passthrough( hoof_value_insert( hoof, hoof->current_value->in ) );
 				}
 
 				hoof_make_current_value( hoof, hoof->current_value->in->down );
 
+				err_passthrough( hoof_journal_value_edit( hoof, ( b * ) "value", hoof->current_value ) );
+
 				hoof->state = hoof_state_new;
 				say( "new" );
 			}	
@@ -487,9 +1065,11 @@
 					goto cleanup;
 				}
 
-				err_passthrough( hoof_value_insert( hoof->current_value->out ) );
+				err_passthrough( hoof_value_insert( hoof, hoof->current_value->out ) );
 				hoof_make_current_value( hoof, hoof->current_value->out->down );
 
+				err_passthrough( hoof_journal_value_edit( hoof, ( b * ) "value", hoof->current_value ) );
+
 				hoof->state = hoof_state_new;
 				say( "new" );
 			}	
@@ -521,6 +1101,7 @@
 			else if ( hoof->literal )
 			{
 				err_passthrough( hoof_word_insert( hoof, interface->input_word ) );
+				err_passthrough( hoof_journal_word_edit( hoof, ( b * ) "word", hoof->current_value, hoof->current_word - 1 ) );
 
 				hoof->literal = 0;
 			}
@@ -530,9 +1111,9 @@
 			}
 			else if ( hear( "done" ) || hear( "D" ) )
 			{
-				if ( hoof->current_word->left->value != null )
+				if ( hoof->current_word > 0 )
 				{
-					hoof->current_word = hoof->current_word->left;
+					hoof->current_word -= 1;
 				}
 
 				hoof->state = hoof_state_navigate;
@@ -541,20 +1122,23 @@
 			// TODO test this
 			else if ( hear( "B") )
 				{
-				if ( hoof->current_word->left->value != null )
+				if ( hoof->current_word > 0 )
 					{
-					hoof_word_delete( hoof, hoof->current_word->left );
+					err_passthrough( hoof_journal_word_edit( hoof, ( b * ) "unword", hoof->current_value, hoof->current_word - 1 ) );
+					hoof_word_delete( hoof, hoof->current_value, hoof->current_word - 1 );
 					}
 				}
 			// TODO test this
 			else if ( hear( "\n" ) )
 			{
-				err_passthrough( hoof_value_insert( hoof->current_value ) );
+				err_passthrough( hoof_value_insert( hoof, hoof->current_value ) );
 				hoof_make_current_value( hoof, hoof->current_value->down );
+				err_passthrough( hoof_journal_value_edit( hoof, ( b * ) "value", hoof->current_value ) );
 			}
 			else
 			{
 				err_passthrough( hoof_word_insert( hoof, interface->input_word ) );
+				err_passthrough( hoof_journal_word_edit( hoof, ( b * ) "word", hoof->current_value, hoof->current_word - 1 ) );
 			}
 
 
@@ -577,13 +1161,17 @@
 			}
 			else if ( hear( "word" ) )
 			{
-				hoof_word_delete( hoof, hoof->current_word );
+				err_passthrough( hoof_journal_word_edit( hoof, ( b * ) "unword", hoof->current_value, hoof->current_word ) );
+
+				hoof_word_delete( hoof, hoof->current_value, hoof->current_word );
 
 				hoof->state = hoof_state_navigate;
 				say( "ok" );
 			}
 			else if ( hear( "value" ) )
 			{
+				err_passthrough( hoof_journal_value_edit( hoof, ( b * ) "unvalue", hoof->current_value ) );
+
 				// say ok first because hoof_value_delete says which direction it went after it deleted the value
 				say( "ok" );
 
@@ -598,7 +1186,7 @@
 
 
 			/* CLEANUP */
-			/* cleanup: */
+			cleanup:
 
 			return rc;
 			}
@@ -607,6 +1195,14 @@
 			/* DATA */
 			n rc = hoof_rc_success;
 
+			struct hoof_intern *intern = null;
+
+			struct hoof_value *value = null;
+			struct hoof_value *page = null;
+
+			n target = 0;
+			n i = 0;
+
 
 			/* CODE */
 			if ( hear( "cancel" ) )
@@ -614,10 +1210,27 @@
 				hoof->state = hoof_state_navigate;
 				say( "cancel" );
 			}
+			else if ( hear( "most" ) )
+			{
+				hoof->steps = hoof_steps_most;
+			}
+			else if ( hear( "page" ) )
+			{
+				hoof->steps = hoof_steps_page;
+			}
+			else if ( hoof_word_steps( interface->input_word, &(hoof->steps) ) )
+			{
+				/* the direction comes next */
+			}
+			else if ( hoof->steps == hoof_steps_page && ( hear( "left" ) || hear( "right" ) ) )
+			{
+				/* a page is values on the screen, not words */
+				(*huh) = 1;
+			}
 			else if ( hear( "left" ) )
 			{
-				if (    hoof->current_word->value == null
-					 || hoof->current_word->left->value == null
+				if (    hoof->current_word >= hoof->current_value->word_count
+					 || hoof->current_word <= 0
 				   )
 				{
 					hoof->state = hoof_state_navigate;
@@ -625,98 +1238,131 @@
 					goto cleanup;
 				}
 
-				/* remove word from list */
-				hoof->current_word->left->right = hoof->current_word->right;
-				hoof->current_word->right->left = hoof->current_word->left;
+				/* the journal sees this as taking the word out and putting it back in */
+				err_passthrough( hoof_journal_word_edit( hoof, ( b * ) "unword", hoof->current_value, hoof->current_word ) );
+
+				/* the words it passes over each shift right one */
+				target = hoof_steps_to( hoof, hoof->current_word, -1, hoof->current_value->word_count - 1 );
+
+				intern = hoof->current_value->words[ hoof->current_word ];
+				for ( i = hoof->current_word; i > target; i -= 1 )
+				{
+					hoof->current_value->words[ i ] = hoof->current_value->words[ i - 1 ];
+				}
+				hoof->current_value->words[ target ] = intern;
+
+				/* the words wrap differently now */
+				hoof->current_value->layout_columns = 0;
+				hoof_page_dirty( hoof, hoof->current_value->out );
 
-				/* update word's links */
-				hoof->current_word->right = hoof->current_word->left;
-				hoof->current_word->left  = hoof->current_word->left->left;
+				hoof->current_word = target;
 
-				/* update left and right links */
-				hoof->current_word->left->right = hoof->current_word;
-				hoof->current_word->right->left = hoof->current_word;
+				err_passthrough( hoof_journal_word_edit( hoof, ( b * ) "word", hoof->current_value, hoof->current_word ) );
 
 				hoof->state = hoof_state_navigate;
 				say( "ok" );
 			}
 			else if ( hear( "right" ) )
 			{
-				if (    hoof->current_word->value == null
-					 || hoof->current_word->right->value == null
-				   )
+				if ( hoof->current_word + 1 >= hoof->current_value->word_count )
 				{
 					hoof->state = hoof_state_navigate;
 					say( "edge" );
 					goto cleanup;
 				}
 
-				/* remove word from list */
-				hoof->current_word->left->right = hoof->current_word->right;
-				hoof->current_word->right->left = hoof->current_word->left;
+				/* the journal sees this as taking the word out and putting it back in */
+				err_passthrough( hoof_journal_word_edit( hoof, ( b * ) "unword", hoof->current_value, hoof->current_word ) );
+
+				/* the words it passes over each shift left one */
+				target = hoof_steps_to( hoof, hoof->current_word, 1, hoof->current_value->word_count - 1 );
+
+				intern = hoof->current_value->words[ hoof->current_word ];
+				for ( i = hoof->current_word; i < target; i += 1 )
+				{
+					hoof->current_value->words[ i ] = hoof->current_value->words[ i + 1 ];
+				}
+				hoof->current_value->words[ target ] = intern;
+
+				hoof->current_value->layout_columns = 0;
+				hoof_page_dirty( hoof, hoof->current_value->out );
 
-				/* update word's links */
-				hoof->current_word->left  = hoof->current_word->right;
-				hoof->current_word->right = hoof->current_word->right->right;
+				hoof->current_word = target;
 
-				/* update left and right links */
-				hoof->current_word->left->right = hoof->current_word;
-				hoof->current_word->right->left = hoof->current_word;
+				err_passthrough( hoof_journal_word_edit( hoof, ( b * ) "word", hoof->current_value, hoof->current_word ) );
 
 				hoof->state = hoof_state_navigate;
 				say( "ok" );
 			}
 			else if ( hear( "up" ) )
 			{
-				if ( hoof->current_value->up->word_head == null )
+				if ( hoof->current_value->up->sentinel )
 				{
 					hoof->state = hoof_state_navigate;
 					say( "edge" );
 					goto cleanup;
 				}
 
-				/* remove value from list */
-				hoof->current_value->up->down = hoof->current_value->down;
-				hoof->current_value->down->up = hoof->current_value->up;
+				/* the journal gets where the value is now and where it ends up */
+				err_passthrough( hoof_journal_text( hoof, ( b * ) "move" ) );
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
 
-				/* update value's links */
-				hoof->current_value->down = hoof->current_value->up;
-				hoof->current_value->up   = hoof->current_value->up->up;
+				/* the page's treap finds where it goes, so a long move doesn't walk the page */
+				page = hoof_index_page( hoof->current_value );
+				target = hoof_steps_to( hoof, hoof_index_of( hoof->current_value ), -1, hoof_index_count( page ) - 1 );
 
-				/* update up and down links */
-				hoof->current_value->up->down = hoof->current_value;
-				hoof->current_value->down->up = hoof->current_value;
+				/* take value out of the page and put it back below the value before target */
+				hoof_value_unlink( hoof, hoof->current_value );
+				value = page;
+				if ( target > 0 )
+				{
+					value = hoof_index_value( page, target - 1 );
+				}
+				hoof_value_link( hoof, hoof->current_value, value );
+
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
+				hoof_journal_end( hoof );
 
 				hoof->state = hoof_state_navigate;
 				say( "ok" );
 			}
 			else if ( hear( "down" ) )
 			{
-				if ( hoof->current_value->down->word_head == null )
+				if ( hoof->current_value->down->sentinel )
 				{
 					hoof->state = hoof_state_navigate;
 					say( "edge" );
 					goto cleanup;
 				}
 
-				/* remove value from list */
-				hoof->current_value->up->down = hoof->current_value->down;
-				hoof->current_value->down->up = hoof->current_value->up;
+				/* the journal gets where the value is now and where it ends up */
+				err_passthrough( hoof_journal_text( hoof, ( b * ) "move" ) );
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
+
+				/* the page's treap finds where it goes, so a long move doesn't walk the page */
+				page = hoof_index_page( hoof->current_value );
+				target = hoof_steps_to( hoof, hoof_index_of( hoof->current_value ), 1, hoof_index_count( page ) - 1 );
 
-				/* update value's links */
-				hoof->current_value->up   = hoof->current_value->down;
-				hoof->current_value->down = hoof->current_value->down->down;
+				/* take value out of the page and put it back below the value before target,
+				   which is the value at target now that this one is out */
+				hoof_value_unlink( hoof, hoof->current_value );
+				value = hoof_index_value( page, target - 1 );
+				hoof_value_link( hoof, hoof->current_value, value );
 
-				/* update up and down links */
-				hoof->current_value->up->down = hoof->current_value;
-				hoof->current_value->down->up = hoof->current_value;
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
+				hoof_journal_end( hoof );
 
 				hoof->state = hoof_state_navigate;
 				say( "ok" );
 			}
+			else if ( hoof->steps != 1 && ( hear( "in" ) || hear( "out" ) ) )
+			{
+				/* values only move in or out one page at a time */
+				(*huh) = 1;
+			}
 			else if ( hear( "in" ) )
 			{
-				if ( hoof->current_value->up->word_head == null )
+				if ( hoof->current_value->up->sentinel )
 				{
 					hoof->state = hoof_state_navigate;
 					say( "edge" );
@@ -725,23 +1371,28 @@
 
 				if ( hoof->current_value->up->in == null )
 				{
-					err_passthrough( hoof_page_init( hoof->current_value->up, 0, null ) );
+					err_passthrough( hoof_page_init( hoof, hoof->current_value->up, 0, null ) );
+				}
+				else
+				{
+					err_passthrough( hoof_page_load( hoof, hoof->current_value->up ) );
 				}
 
-				/* remove value from list */
-				hoof->current_value->up->down = hoof->current_value->down;
-				hoof->current_value->down->up = hoof->current_value->up;
+				/* the journal gets where the value is now and where it ends up */
+				err_passthrough( hoof_journal_text( hoof, ( b * ) "move" ) );
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
 
-				/* update value's links */
-				hoof->current_value->down = hoof->current_value->up->in->down;
-				hoof->current_value->up   = hoof->current_value->up->in;
+				/* take value out of the page and put it at the top of up's in */
+				value = hoof->current_value->up->in;
+				hoof_value_unlink( hoof, hoof->current_value );
+				hoof_value_link( hoof, hoof->current_value, value );
 
-				/* update up and down links */
-				hoof->current_value->up->down = hoof->current_value;
-				hoof->current_value->down->up = hoof->current_value;
+				/* the value's new page hasn't been drawn */
+				hoof->view_first = 0;
+				hoof->view_count = 0;
 
-				/* update out link */
-				hoof->current_value->out = hoof->current_value->up->out;
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
+				hoof_journal_end( hoof );
 
 				hoof->state = hoof_state_navigate;
 				say( "ok" );
@@ -755,29 +1406,128 @@
 					goto cleanup;
 				}
 
-				/* remove value from list */
-				hoof->current_value->up->down = hoof->current_value->down;
-				hoof->current_value->down->up = hoof->current_value->up;
+				/* the journal gets where the value is now and where it ends up */
+				err_passthrough( hoof_journal_text( hoof, ( b * ) "move" ) );
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
 
-				/* update value's links */
-				hoof->current_value->up   = hoof->current_value->out;
-				hoof->current_value->down = hoof->current_value->out->down;
+				/* take value out of the page and put it below out */
+				value = hoof->current_value->out;
+				hoof_value_unlink( hoof, hoof->current_value );
+				hoof_value_link( hoof, hoof->current_value, value );
 
-				/* update up and down links */
-				hoof->current_value->up->down = hoof->current_value;
-				hoof->current_value->down->up = hoof->current_value;
-
-				/* update out */
-				hoof->current_value->out  = hoof->current_value->up->out;
+				/* the value's new page hasn't been drawn */
+				hoof->view_first = 0;
+				hoof->view_count = 0;
 
 				/* see if up's in (old out's in) is empty */
-				if ( hoof->current_value->up->in->down->word_head == null )
+				if ( hoof->current_value->up->in->down->sentinel )
+				{
+					hoof_page_free( hoof, &(hoof->current_value->up->in) );
+				}
+
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
+				hoof_journal_end( hoof );
+
+				hoof->state = hoof_state_navigate;
+				say( "ok" );
+			}
+			else
+			{
+				(*huh) = 1;
+			}
+
+
+			/* CLEANUP */
+			cleanup:
+
+			return rc;
+			}
+		static n hoof_state_go_choice( struct hoof *hoof, struct hoof_interface *interface, n *huh )
+			{
+			/*!	\brief State Go Choice. Goes a number of values or words at once, like go 12 down.
+				\param[in] hoof struct hoof Context.
+				\param[in] interface struct hoof Interface.
+				\param[out] huh If this state doesn't understand the input word, it will set huh to 1.
+				\return HOOF_RC
+
+				If it can't go that far it stops at the edge.
+				*/
+			/* DATA */
+			n rc = hoof_rc_success;
+
+			struct hoof_value *page = null;
+
+			n target = 0;
+
+
+			/* CODE */
+			if ( hear( "cancel" ) )
+			{
+				hoof->state = hoof_state_navigate;
+				say( "cancel" );
+			}
+			else if ( hear( "most" ) )
+			{
+				hoof->steps = hoof_steps_most;
+			}
+			else if ( hear( "page" ) )
+			{
+				hoof->steps = hoof_steps_page;
+			}
+			else if ( hoof_word_steps( interface->input_word, &(hoof->steps) ) )
+			{
+				/* the direction comes next */
+			}
+			else if ( hoof->steps == hoof_steps_page && ( hear( "left" ) || hear( "right" ) ) )
+			{
+				/* a page is values on the screen, not words */
+				(*huh) = 1;
+			}
+			else if ( hear( "left" ) )
+			{
+				if ( hoof->current_word <= 0 )
+				{
+					hoof->state = hoof_state_navigate;
+					say( "edge" );
+					goto cleanup;
+				}
+
+				hoof->current_word = hoof_steps_to( hoof, hoof->current_word, -1, hoof->current_value->word_count - 1 );
+
+				hoof->state = hoof_state_navigate;
+				say( "ok" );
+			}
+			else if ( hear( "right" ) )
+			{
+				if ( hoof->current_word + 1 >= hoof->current_value->word_count )
+				{
+					hoof->state = hoof_state_navigate;
+					say( "edge" );
+					goto cleanup;
+				}
+
+				hoof->current_word = hoof_steps_to( hoof, hoof->current_word, 1, hoof->current_value->word_count - 1 );
+
+				hoof->state = hoof_state_navigate;
+				say( "ok" );
+			}
+			else if ( hear( "up" ) || hear( "down" ) )
+			{
+				if (    ( hear( "up" ) && hoof->current_value->up->sentinel )
+					 || ( hear( "down" ) && hoof->current_value->down->sentinel )
+				   )
 				{
-					hoof_memory_free( hoof->current_value->up->in->down );
-					hoof_memory_free( hoof->current_value->up->in );
-					hoof->current_value->up->in = null;
+					hoof->state = hoof_state_navigate;
+					say( "edge" );
+					goto cleanup;
 				}
 
+				/* the page's treap goes straight to the value, so a long jump doesn't walk the page */
+				page = hoof_index_page( hoof->current_value );
+				target = hoof_steps_to( hoof, hoof_index_of( hoof->current_value ), hear( "up" ) ? -1 : 1, hoof_index_count( page ) - 1 );
+
+				hoof_make_current_value( hoof, hoof_index_value( page, target ) );
+
 				hoof->state = hoof_state_navigate;
 				say( "ok" );
 			}
@@ -805,6 +1555,8 @@
 			/* DATA */
 			n rc = hoof_rc_success;
 
+			struct hoof_value *page = null;
+
 
 			/* CODE */
 			(void)huh;
@@ -829,7 +1581,7 @@
 				hoof_dig( hoof, null );
 
 				/* if tail */
-				if ( hoof->current_value->word_head == null )
+				if ( hoof->current_value->sentinel )
 				{
 					/* we're done with our dig */
 					goto cleanup;
@@ -840,18 +1592,18 @@
 				{
 					/* go to tail to mark that we couldnt go in, which
 					   will also end our dig */
-					while ( hoof->current_value->down != null )
-					{
-						hoof->current_value = hoof->current_value->down;
-					}
+					page = hoof_index_page( hoof->current_value );
+					hoof->current_value = hoof_index_value( page, hoof_index_count( page ) - 1 )->down;
 
 					goto cleanup;
 				}
 
 				/* go in */
+				err_passthrough( hoof_page_load( hoof, hoof->current_value ) );
 				hoof_make_current_value( hoof, hoof->current_value->in->down );
-				/* need to start with current_word as word_head */
-				hoof->current_word = hoof->current_value->word_head;
+				/* need to start with current_word before the first word */
+				hoof->current_word = -1;
+				hoof->dig_candidate_words = -1;
 			}
 			else if ( hear( "done" ) )
 			{
@@ -859,7 +1611,7 @@
 				hoof_dig( hoof, null );
 
 				/* if tail */
-				if ( hoof->current_value->word_head == null )
+				if ( hoof->current_value->sentinel )
 				{
 					hoof_make_current_value( hoof, hoof->current_value->up );
 					hoof->state = hoof_state_navigate;
@@ -877,7 +1629,7 @@
 				/* we want to find a value that just "starts with", so stick with whatever value we're currently at */
 
 				/* if tail */
-				if ( hoof->current_value->word_head == null )
+				if ( hoof->current_value->sentinel )
 				{
 					hoof_make_current_value( hoof, hoof->current_value->up );
 					hoof->state = hoof_state_navigate;
@@ -901,112 +1653,134 @@
 
 			return rc;
 			}
-	// loading and saving
-		static n hoof_load( struct hoof *hoof )
+		static n hoof_state_search( struct hoof *hoof, struct hoof_interface *interface, n *huh )
 			{
+			/*!	\brief State Search. Finds the values anywhere in the hierarchy that have some words.
+				\param[in] hoof struct hoof Context.
+				\param[in] interface struct hoof Interface.
+				\param[out] huh If this state doesn't understand the input word, it will set huh to 1.
+				\return HOOF_RC
+
+				The words are collected until done, then we go to the first value at or after
+				the current value that has them next to each other. next and previous in
+				navigate go through the rest.
+				*/
 			/* DATA */
 			n rc = hoof_rc_success;
 
-			FILE *fp = null;
-
-			struct hoof_interface interface;
+			n found = 0;
 
-			n done = 0;
-
-			n i = 0;
-			b ch = 0;
+			b count[ hoof_int_max_string_length + 1 ];
 
 
 			/* CODE */
-			hoof->loading = 1;
-			hoof->state = hoof_state_navigate;
-
-			fp = hoof_hook_fopen( ( char * ) hoof->filename, "r" );
-			err_if( fp == null, hoof_rc_error_file );
-
-			while ( 1 )
+			if ( hear( "" ) )
 			{
-				/* get next word */
-				i = 0;
-				interface.input_word[ 0 ] = '\0';
-
-				while ( 1 )
-				{
-					if ( hoof_hook_fread( &ch, 1, 1, fp ) != 1 )
-					{
-						err_if( ! feof( fp ), hoof_rc_error_file );
-
-						done = 1;
-						break;
-					}
-
-					if ( ch == ' ' || ch == '\n' || ch == '\r' )
-					{
-						break;
-					}
-
-					err_if( i >= hoof_max_word_length, hoof_rc_error_word_long );
-
-					interface.input_word[ i ] = ch;
-					interface.input_word[ i + 1 ] = '\0';
+				goto cleanup;
+			}
+			else if ( hoof->literal )
+			{
+				hoof_search_word( hoof, interface->input_word, huh );
+				hoof->literal = 0;
+			}
+			else if ( hear( "literal" ) )
+			{
+				hoof->literal = 1;
+			}
+			else if ( hear( "cancel" ) )
+			{
+				hoof->search_word_count = 0;
+				hoof->state = hoof_state_navigate;
+				say( "cancel" );
+			}
+			else if ( hear( "done" ) )
+			{
+				hoof->state = hoof_state_navigate;
 
-					i += 1;
+				if ( hoof->search_word_count == 0 )
+				{
+					say( "empty" );
+					goto cleanup;
 				}
 
-				if ( done )
+				err_passthrough( hoof_search_find( hoof ) );
+				err_passthrough( hoof_search_step( hoof, 0, &found ) );
+
+				if ( ! found )
 				{
-					break;
+					say( "empty" );
+					goto cleanup;
 				}
 
-				/* feed into hoof_do */
-				err_passthrough( hoof_do( hoof, &interface ) );
-				/* TODO: when we have a better loading file format, this can go away */
-				err_if( interface.output_value[ 1 ][ 0 ] != '\0', hoof_rc_error_file_bad );
-			}
-
-			hoof_root( hoof );
+				/* how many values have the words */
+				count[ hoof_number_text( hoof->search_result_count, count ) ] = '\0';
 
-			hoof->loading = 0;
-			hoof->state = hoof_state_navigate;
+				say( "ok" );
+				say( count );
+			}
+			else
+			{
+				hoof_search_word( hoof, interface->input_word, huh );
+			}
 
 
 			/* CLEANUP */
 			cleanup:
 
-			if ( fp != null )
-			{
-				fclose( fp );
-				fp = null;
-			}
-
 			return rc;
 			}
-		static n hoof_save_word( FILE *fp, b *word, n newline )
+		static n hoof_state_sort_choice( struct hoof *hoof, struct hoof_interface *interface, n *huh )
 			{
+			/*!	\brief State Sort Choice. Sorts the current value's page.
+				\param[in] hoof struct hoof Context.
+				\param[in] interface struct hoof Interface.
+				\param[out] huh If this state doesn't understand the input word, it will set huh to 1.
+				\return HOOF_RC
+
+				all first sorts every page inside the page too, then done sorts smallest first
+				and reverse sorts biggest first. The current value stays the same value.
+				*/
 			/* DATA */
 			n rc = hoof_rc_success;
 
-			size_t i = 0;
-
-			b ch_space = ' ';
-			b ch_newline = '\n';
-
 
 			/* CODE */
-			while ( word[ i ] != '\0' )
+			if ( hear( "cancel" ) )
 			{
-				i += 1;
+				hoof->state = hoof_state_navigate;
+				say( "cancel" );
+			}
+			else if ( hear( "all" ) )
+			{
+				hoof->sort_mode |= hoof_sort_all;
 			}
+			else if ( hear( "done" ) || hear( "reverse" ) )
+			{
+				if ( hear( "reverse" ) )
+				{
+					hoof->sort_mode |= hoof_sort_reverse;
+				}
 
-			err_if( hoof_hook_fwrite( word, 1, i, fp ) != i, hoof_rc_error_file );
+				hoof->state = hoof_state_navigate;
 
-			if ( newline )
-			{
-				err_if( hoof_hook_fwrite( &ch_newline, 1, 1, fp ) != 1, hoof_rc_error_file );
+				/* pages inside are loaded before the journal gets the edit, so a failed load changes nothing */
+				if ( hoof->sort_mode & hoof_sort_all )
+				{
+					err_passthrough( hoof_sort_load( hoof, hoof_index_page( hoof->current_value ) ) );
+				}
+
+				err_passthrough( hoof_journal_text( hoof, ( b * ) "sort" ) );
+				err_passthrough( hoof_journal_path( hoof, hoof->current_value ) );
+				err_passthrough( hoof_journal_number( hoof, hoof->sort_mode ) );
+				hoof_journal_end( hoof );
+
+				err_passthrough( hoof_sort( hoof, hoof->current_value, hoof->sort_mode ) );
+
+				say( "ok" );
 			}
 			else
 			{
-				err_if( hoof_hook_fwrite( &ch_space, 1, 1, fp ) != 1, hoof_rc_error_file );
+				(*huh) = 1;
 			}
 
 
@@ -1015,185 +1789,4007 @@
 
 			return rc;
 			}
-		static n hoof_save_value( FILE *fp, struct hoof_value *value, b *direction )
+	// loading and saving
+		static n hoof_reader_fill( struct hoof_reader * reader )
 			{
-			/* DATA */
-			n rc = hoof_rc_success;
-
-			struct hoof_word *word = null;
-
-
-			/* CODE */
-			paranoid_err_if( value == null );
-			paranoid_err_if( value->word_head == null );
-			paranoid_err_if( value->word_head->value != null );
-			paranoid_err_if( value->word_head->right == null );
-			paranoid_err_if( value->word_head->right->left != value->word_head );
-			paranoid_err_if( value->word_head->left != null );
-
-			word = value->word_head->right;
-
-			err_passthrough( hoof_save_word( fp, ( b * ) "new", 0 ) );
-			err_passthrough( hoof_save_word( fp, direction, 0 ) );
-
-			paranoid_err_if( word == null );
-
-			while ( word->value != null )
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			reader -> offset += reader -> size ;
+			reader -> index = 0 ;
+			reader -> size = hoof_hook_fread( reader -> buffer , 1 , hoof_read_buffer_size , reader -> fp ) ;
+			reader -> hash = hoof_hash_bytes( reader -> hash , reader -> buffer , reader -> size ) ;
+			// nothing read means either end of file or an error
+			if ( reader -> size == 0 )
+				{
+				err_if( ! feof( reader -> fp ) , hoof_rc_error_file ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_reader_word( struct hoof_reader * reader , b * word , n * done )
 			{
-				paranoid_err_if( word->left->right != word );
-				paranoid_err_if( word->right->left != word );
-
-				if (    hoof_words_are_same( word->value, ( b * ) "done" )
-					 || hoof_words_are_same( word->value, ( b * ) "pause" )
-					 || hoof_words_are_same( word->value, ( b * ) "literal" )
-				   )
+			// data
+			n rc = hoof_rc_success ;
+			n i = 0 ;
+			b ch = 0 ;
+			// code
+			word[ 0 ] = '\0' ;
+			while ( 1 )
 				{
-					err_passthrough( hoof_save_word( fp, ( b * ) "literal", 0 ) );
+				if ( reader -> index == reader -> size )
+					{
+					err_passthrough( hoof_reader_fill( reader ) ) ;
+					// note: a word at the very end of the file without whitespace after it is ignored
+					if ( reader -> size == 0 )
+						{
+						( * done ) = 1 ;
+						break ;
+						}
+					}
+				ch = reader -> buffer[ reader -> index ] ;
+				reader -> index += 1 ;
+				if ( ch == ' ' || ch == '\n' || ch == '\r' )
+					{
+					break ;
+					}
+				err_if( i >= hoof_max_word_length , hoof_rc_error_word_long ) ;
+				word[ i ] = ch ;
+				word[ i + 1 ] = '\0' ;
+				i += 1 ;
 				}
-
-				err_passthrough( hoof_save_word( fp, word->value, 0 ) );
-
-				word = word->right;
+			// cleanup
+			cleanup:
+			return rc ;
 			}
-
-			paranoid_err_if( word->left->right != word );
-			paranoid_err_if( word->right != null );
-
-			err_passthrough( hoof_save_word( fp, ( b * ) "done", 1 ) );
-
-
-			/* CLEANUP */
+		static n hoof_reader_byte( struct hoof_reader * reader , b * byte , n * done )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			if ( reader -> index == reader -> size )
+				{
+				err_passthrough( hoof_reader_fill( reader ) ) ;
+				if ( reader -> size == 0 )
+					{
+					( * done ) = 1 ;
+					goto cleanup ;
+					}
+				}
+			( * byte ) = reader -> buffer[ reader -> index ] ;
+			reader -> index += 1 ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_reader_number( struct hoof_reader * reader , n * number , n * done )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			n shift = 0 ;
+			n end = 0 ;
+			b byte = 0 ;
+			// code
+			// numbers are stored 7 bits at a time, lowest bits first, high bit set means more bytes follow
+			( * number ) = 0 ;
+			while ( 1 )
+				{
+				err_passthrough( hoof_reader_byte( reader , & byte , & end ) ) ;
+				if ( end )
+					{
+					// the file can end between numbers but not in the middle of one
+					err_if( shift != 0 , hoof_rc_error_file_bad ) ;
+					( * done ) = 1 ;
+					break ;
+					}
+				// 9 bytes fill all 63 bits of a positive n
+				err_if( shift == 63 , hoof_rc_error_file_bad ) ;
+				( * number ) |= ( ( n ) ( byte & 0x7f ) ) << shift ;
+				shift += 7 ;
+				if ( ( byte & 0x80 ) == 0 )
+					{
+					break ;
+					}
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_build_value( struct hoof_builder * builder , n record )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * value = NULL ;
+			struct hoof_value * page = NULL ;
+			// code
+			// inside a page we're not loading yet, we only keep track of how deep we are
+			if ( builder -> skip > 0 )
+				{
+				if ( record == hoof_record_in )
+					{
+					builder -> skip += 1 ;
+					}
+				goto cleanup ;
+				}
+			value = builder -> value ;
+			if ( record == hoof_record_down )
+				{
+				err_passthrough( hoof_value_insert( builder -> hoof , value ) ) ;
+				value = value -> down ;
+				}
+			else if ( record == hoof_record_in )
+				{
+				if ( value -> in == NULL && builder -> lazy )
+					{
+					// leave an unloaded page that remembers where it starts in the file
+					err_passthrough( hoof_page_init( builder -> hoof , value , 0 , & page ) ) ;
+					page -> page -> unloaded = 1 ;
+					builder -> hoof -> some_unloaded = 1 ;
+					page -> page -> offset = builder -> offset + 1 ;
+					builder -> skip = 1 ;
+					goto cleanup ;
+					}
+				if ( value -> in == NULL )
+					{
+					err_passthrough( hoof_page_init( builder -> hoof , value , 1 , & page ) ) ;
+					page -> page -> offset = builder -> offset + 1 ;
+					}
+				else
+					{
+					// the value already has a page, which might not be loaded yet
+					err_passthrough( hoof_page_load( builder -> hoof , value ) ) ;
+					err_passthrough( hoof_value_insert( builder -> hoof , value -> in ) ) ;
+					// coming back in to a page means the page isn't in one piece in the file
+					if ( ! ( builder -> page && builder -> depth == 0 ) )
+						{
+						value -> in -> page -> offset = 0 ;
+						}
+					}
+				value = value -> in -> down ;
+				builder -> depth += 1 ;
+				}
+			// right keeps adding to the end of the current value
+			builder -> value = value ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_build_word( struct hoof_builder * builder , b * word )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			if ( builder -> skip > 0 )
+				{
+				goto cleanup ;
+				}
+			err_if( builder -> value -> word_count == hoof_max_value_length , hoof_rc_error_value_long ) ;
+			err_passthrough( hoof_word_add( builder -> hoof , builder -> value , builder -> value -> word_count , word ) ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_build_backspace( struct hoof_builder * builder )
+			{
+			if ( builder -> skip == 0 && builder -> value -> word_count > 0 )
+				{
+				hoof_word_delete( builder -> hoof , builder -> value , builder -> value -> word_count - 1 ) ;
+				}
+			}
+		static void hoof_build_out( struct hoof_builder * builder , n end )
+			{
+			// data
+			struct hoof_value * page = NULL ;
+			// code
+			if ( builder -> skip > 0 )
+				{
+				builder -> skip -= 1 ;
+				// back out of a page we're leaving unloaded, so now we know how long it is
+				if ( builder -> skip == 0 )
+					{
+					page = builder -> value -> in ;
+					page -> page -> length = end - ( page -> page -> offset - 1 ) ;
+					}
+				return ;
+				}
+			if ( builder -> value -> out != NULL )
+				{
+				page = builder -> value -> out -> in ;
+				if ( page -> page -> offset != 0 )
+					{
+					page -> page -> length = end - ( page -> page -> offset - 1 ) ;
+					}
+				builder -> value = builder -> value -> out ;
+				builder -> depth -= 1 ;
+				// when loading a single page we stop once we come back out of it
+				if ( builder -> page && builder -> depth == 0 )
+					{
+					builder -> finished = 1 ;
+					}
+				}
+			}
+		static n hoof_load( struct hoof * hoof )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_reader reader = { NULL , NULL , 0 , 0 , 0 , 0 } ;
+			struct hoof_builder builder = { NULL , NULL , 0 , 0 , 0 , 0 , 0 , 0 , 0 } ;
+			n i = 0 ;
+			// code
+			reader . fp = hoof_hook_fopen( ( char * ) hoof -> filename , "r" ) ;
+			err_if( reader . fp == NULL , hoof_rc_error_file ) ;
+			hoof_memory_malloc( reader . buffer , b , hoof_read_buffer_size ) ;
+			reader . hash = hoof_hash_start ;
+			builder . hoof = hoof ;
+			builder . value = hoof -> root -> down ;
+			builder . lazy = ( hoof -> options & hoof_option_lazy ) ;
+			// binary files start with the magic, anything else is a text file
+			err_passthrough( hoof_reader_fill( & reader ) ) ;
+			hoof -> binary = 0 ;
+			if ( reader . size >= hoof_binary_magic_length )
+				{
+				hoof -> binary = 1 ;
+				for ( i = 0 ; i < hoof_binary_magic_length ; i += 1 )
+					{
+					if ( reader . buffer[ i ] != ( b ) hoof_binary_magic[ i ] )
+						{
+						hoof -> binary = 0 ;
+						break ;
+						}
+					}
+				}
+			hoof -> file_binary = hoof -> binary ;
+			hoof -> building = 1 ;
+			if ( hoof -> binary )
+				{
+				reader . index = hoof_binary_magic_length ;
+				err_passthrough( hoof_load_binary( hoof , & reader , & builder ) ) ;
+				}
+			else
+				{
+				err_passthrough( hoof_load_text( & reader , & builder ) ) ;
+				hoof -> building = 0 ;
+				if ( builder . replay )
+					{
+					err_passthrough( hoof_load_replay( hoof , & reader ) ) ;
+					}
+				}
+			// a journal only goes with exactly the file we just read
+			hoof -> building = 0 ;
+			hoof -> base_length = reader . offset ;
+			hoof -> base_hash = reader . hash ;
+			err_passthrough( hoof_journal_load( hoof ) ) ;
+			// the file and journal have everything now, unless the file was empty
+			hoof -> modified = ( hoof -> base_length == 0 ) ;
+			hoof -> copy_pages = 1 ;
+			hoof_root( hoof ) ;
+			hoof -> state = hoof_state_navigate ;
+			// cleanup
 			cleanup:
+			hoof -> building = 0 ;
+			hoof_memory_free( reader . buffer ) ;
+			if ( reader . fp != NULL )
+				{
+				fclose( reader . fp ) ;
+				reader . fp = NULL ;
+				}
+			return rc ;
+			}
+		static n hoof_page_load( struct hoof * hoof , struct hoof_value * value )
+			{
+			/*!	\brief Loads the unloaded page of a value, if it has one.
+				\param[in] hoof struct hoof context.
+				\param[in] value Value whose in page we're about to use.
+				\return n
 
-			return rc;
+				Only this one page is built, its values' pages stay unloaded.
+				If loading fails the page is left unloaded just like it was.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_reader reader = { NULL , NULL , 0 , 0 , 0 , 0 } ;
+			struct hoof_builder builder = { NULL , NULL , 0 , 0 , 0 , 0 , 0 , 0 , 0 } ;
+			struct hoof_value * page = NULL ;
+			struct hoof_value * value_to_delete = NULL ;
+			n unloaded = 0 ;
+			// code
+			if ( value -> in == NULL || value -> in -> page -> unloaded == 0 )
+				{
+				goto cleanup ;
+				}
+			page = value -> in ;
+			unloaded = page -> page -> unloaded ;
+			page -> page -> unloaded = 0 ;
+			hoof -> building = 1 ;
+			reader . fp = hoof_hook_fopen( ( char * ) hoof -> filename , "r" ) ;
+			err_if( reader . fp == NULL , hoof_rc_error_file ) ;
+			err_if( fseek( reader . fp , ( long ) ( page -> page -> offset - 1 ) , SEEK_SET ) != 0 , hoof_rc_error_file ) ;
+			reader . offset = page -> page -> offset - 1 ;
+			hoof_memory_malloc( reader . buffer , b , hoof_read_buffer_size ) ;
+			builder . hoof = hoof ;
+			builder . value = value ;
+			builder . lazy = 1 ;
+			builder . page = 1 ;
+			// the first record is the in that starts this page
+			if ( hoof -> file_binary )
+				{
+				err_passthrough( hoof_load_records( & reader , & builder , hoof -> dictionary , hoof -> dictionary_count ) ) ;
+				}
+			else
+				{
+				err_passthrough( hoof_load_text( & reader , & builder ) ) ;
+				// the whole file was built when it was loaded, so this only happens if it changed since
+				err_if( builder . replay , hoof_rc_error_file_bad ) ;
+				}
+			err_if( page -> down -> sentinel , hoof_rc_error_file_bad ) ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( reader . buffer ) ;
+			if ( reader . fp != NULL )
+				{
+				fclose( reader . fp ) ;
+				reader . fp = NULL ;
+				}
+			// put the page back the way it was
+			if ( rc != hoof_rc_success && page != NULL )
+				{
+				while ( ! page -> down -> sentinel )
+					{
+					value_to_delete = page -> down ;
+					hoof_page_delete( hoof , & ( value_to_delete -> in ) ) ;
+					hoof_value_unlink( hoof , value_to_delete ) ;
+					hoof_value_clear( hoof , value_to_delete ) ;
+					hoof_value_free( hoof , value_to_delete ) ;
+					}
+				page -> page -> unloaded = unloaded ;
+				}
+			hoof -> building = 0 ;
+			return rc ;
 			}
-		static n hoof_save( struct hoof *hoof )
+		static n hoof_load_text( struct hoof_reader * reader, struct hoof_builder * builder )
 			{
+			/*!	\brief Builds the hierarchy straight from the words of a text file.
+				\param[in] reader File to read, may already hold the first block.
+				\param[in] builder Where new values and words go.
+				\return n
+
+				The file is what hoof_save writes
+					new right|down|in word word ... done
+					out
+				with literal in front of any word that would otherwise be a command.
+				Pause and resume are honored the same way hoof_do honors them.
+				Anything else sets builder's replay and stops, the file is then loaded with hoof_load_replay.
+				*/
 			/* DATA */
 			n rc = hoof_rc_success;
 
-			n i = 0;
-
-			/* +1 for null +1 for dot at beginning */
-			b temp_filename[ hoof_max_word_length + 2 ] = "";
+			b word[ hoof_max_word_length + 1 ];
 
-			FILE *fp = null;
+			n done = 0;
 
-			struct hoof_value *value = null;
+			n choosing = 0;
+			n adding = 0;
+			n literal = 0;
+			n paused = 0;
 
-			n first = 1;
+			n offset = 0;
 
 
 			/* CODE */
-			/* create temp filename */
-			temp_filename[ 0 ] = '.';
-			while ( hoof->filename[ i ] != '\0' )
+			while ( builder->finished == 0 )
 			{
-				temp_filename[ i + 1 ] = hoof->filename[ i ];
-				i += 1;
-			}
-			temp_filename[ i + 1 ] = '\0';
+				/* get next word */
+				offset = reader->offset + reader->index;
 
-			/* open temp filename */
-			fp = hoof_hook_fopen( ( char * ) temp_filename, "w+" );
-			err_if( fp == null, hoof_rc_error_file );
+				err_passthrough( hoof_reader_word( reader, word, &done ) );
 
-			/* write file */
-			value = hoof->root->down;
+				if ( done )
+				{
+					break;
+				}
 
-			paranoid_err_if( value == null );
-			paranoid_err_if( value->word_head == null );
-			paranoid_err_if( value->up->word_head != null );
+				err_passthrough( hoof_word_verify( word ) );
 
-			while ( value != null )
-			{
-				paranoid_err_if( value->up->down != value );
-				paranoid_err_if( value->down->up != value );
-				paranoid_err_if( value->out != value->up->out );
-				paranoid_err_if( value->out != value->down->out );
+				if ( word[ 0 ] == '\0' )
+				{
+					continue;
+				}
 
-				if ( first )
+				/* handle pause and resume */
+				if ( paused )
 				{
-					err_passthrough( hoof_save_value( fp, value, ( b * ) "right" ) );
-					first = 0;
+					if ( hoof_words_are_same( word, ( b * ) "resume" ) )
+					{
+						paused = 0;
+					}
+					continue;
 				}
-				else
+
+				if ( literal == 0 && hoof_words_are_same( word, ( b * ) "pause" ) )
 				{
-					err_passthrough( hoof_save_value( fp, value, ( b * ) "down" ) );
+					paused = 1;
+					continue;
 				}
 
-				/* go most in */
-				while ( value->in != null )
+				/* words of a value */
+				if ( adding )
 				{
-					paranoid_err_if( value->in->out != value );
-					paranoid_err_if( value->in->word_head != null );
-					paranoid_err_if( value->in->down == null );
+					if ( literal == 0 && hoof_words_are_same( word, ( b * ) "literal" ) )
+					{
+						literal = 1;
+					}
+					else if ( literal == 0 && ( hoof_words_are_same( word, ( b * ) "done" ) || hoof_words_are_same( word, ( b * ) "D" ) ) )
+					{
+						adding = 0;
+					}
+					else if ( literal == 0 && hoof_words_are_same( word, ( b * ) "B" ) )
+					{
+						hoof_build_backspace( builder );
+					}
+					else
+					{
+						err_passthrough( hoof_build_word( builder, word ) );
 
-					value = value->in->down;
+						literal = 0;
+					}
+				}
+				/* direction after new */
+				else if ( choosing )
+				{
+					if ( hoof_words_are_same( word, ( b * ) "right" ) )
+					{
+						err_passthrough( hoof_build_value( builder, hoof_record_right ) );
+					}
+					else if ( hoof_words_are_same( word, ( b * ) "down" ) )
+					{
+						err_passthrough( hoof_build_value( builder, hoof_record_down ) );
+					}
+					else if ( hoof_words_are_same( word, ( b * ) "in" ) )
+					{
+						err_passthrough( hoof_build_value( builder, hoof_record_in ) );
+					}
+					else
+					{
+						/* like new left, hoof_save never writes it */
+						builder->replay = 1;
+						break;
+					}
 
-					paranoid_err_if( value->up->down != value );
-					paranoid_err_if( value->down->up != value );
-					paranoid_err_if( value->out != value->up->out );
-					paranoid_err_if( value->out != value->down->out );
+					choosing = 0;
+					adding = 1;
+				}
+				else if ( hoof_words_are_same( word, ( b * ) "new" ) )
+				{
+					/* unloaded pages remember where their record starts */
+					builder->offset = offset;
 
-					err_passthrough( hoof_save_value( fp, value, ( b * ) "in" ) );
+					choosing = 1;
+				}
+				else if ( hoof_words_are_same( word, ( b * ) "out" ) )
+				{
+					hoof_build_out( builder, offset + 3 );
+				}
+				else
+				{
+					/* a command like up or go, hoof_save never writes them */
+					builder->replay = 1;
+					break;
 				}
+			}
 
-				/* go down */
-				value = value->down;
 
-				paranoid_err_if( value->up->down != value );
-				paranoid_err_if( value->down != null && value->down->up != value );
-				paranoid_err_if( value->out != value->up->out );
-				paranoid_err_if( value->down != null && value->out != value->down->out );
+			/* CLEANUP */
+			cleanup:
 
-				/* if tail */
-				if ( value->word_head == null )
+			return rc;
+			}
+		static n hoof_load_replay( struct hoof * hoof , struct hoof_reader * reader )
+			{
+			/*!	\brief Loads a text file by giving each of its words to hoof_do.
+				\param[in] hoof struct hoof context.
+				\param[in] reader The file, it's read again from the start.
+				\return n
+
+				This is how every file used to be loaded, it's still used for files that have more than
+				the save grammar, like new left or up. Whatever hoof_load_text built is thrown away.
+				save and quit in the file, or anything hoof_do says more than one word to, make the file bad.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_interface interface ;
+			n done = 0 ;
+			// code
+			hoof -> current_value = NULL ;
+			hoof_page_delete( hoof , & ( hoof -> root ) ) ;
+			hoof -> some_unloaded = 0 ;
+			err_passthrough( hoof_page_init( hoof , NULL , 1 , & ( hoof -> root ) ) ) ;
+			hoof_make_current_value( hoof , hoof -> root -> down ) ;
+			err_if( fseek( reader -> fp , 0 , SEEK_SET ) != 0 , hoof_rc_error_file ) ;
+			reader -> size = 0 ;
+			reader -> index = 0 ;
+			reader -> offset = 0 ;
+			reader -> hash = hoof_hash_start ;
+			hoof -> loading = 1 ;
+			hoof -> state = hoof_state_navigate ;
+			while ( 1 )
 				{
-					paranoid_err_if( value->down != null );
-
-					/* while tail */
-					while ( value->word_head == null )
+				err_passthrough( hoof_reader_word( reader , interface . input_word , & done ) ) ;
+				if ( done )
 					{
-						/* if we cant go out */
-						if ( value->out == null )
+					break ;
+					}
+				err_passthrough( hoof_do( hoof , & interface ) ) ;
+				err_if( interface . output_value[ 1 ][ 0 ] != '\0' , hoof_rc_error_file_bad ) ;
+				}
+			// cleanup
+			cleanup:
+			hoof -> loading = 0 ;
+			return rc ;
+			}
+		static n hoof_load_binary( struct hoof * hoof , struct hoof_reader * reader , struct hoof_builder * builder )
+			{
+			/*	binary file layout, every number is stored 7 bits at a time
+					magic "hoof" and its null
+					version
+					number of words in the dictionary
+						each word is a length byte then its characters
+					records until the end of the file
+						right down or in, then number of words, then the dictionary index of each word
+						out
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			n done = 0 ;
+			n version = 0 ;
+			n count = 0 ;
+			struct hoof_intern * * words = NULL ;
+			struct hoof_intern * * new_words = NULL ;
+			n capacity = 0 ;
+			b word[ hoof_max_word_length + 1 ] ;
+			b length = 0 ;
+			n i = 0 ;
+			n j = 0 ;
+			// code
+			err_passthrough( hoof_reader_number( reader , & version , & done ) ) ;
+			err_if( done || version != hoof_binary_version , hoof_rc_error_file_bad ) ;
+			// dictionary
+			err_passthrough( hoof_reader_number( reader , & count , & done ) ) ;
+			err_if( done || count > hoof_binary_dictionary_max , hoof_rc_error_file_bad ) ;
+			for ( i = 0 ; i < count ; i += 1 )
+				{
+				// the words grow as they're read, so a count the file doesn't have the words for can't make us allocate much
+				if ( i == capacity )
+					{
+					capacity *= 2 ;
+					if ( capacity == 0 )
 						{
-							/* we're done, we use value to break all loops */
-							value = null;
-							break;
+						capacity = hoof_dictionary_capacity_initial ;
 						}
+					if ( capacity > count )
+						{
+						capacity = count ;
+						}
+					hoof_memory_calloc( new_words , struct hoof_intern * , capacity ) ;
+					for ( j = 0 ; j < i ; j += 1 )
+						{
+						new_words[ j ] = words[ j ] ;
+						}
+					hoof_memory_free( words ) ;
+					words = new_words ;
+					new_words = NULL ;
+					}
+				err_passthrough( hoof_reader_byte( reader , & length , & done ) ) ;
+				err_if( done || length == 0 , hoof_rc_error_file_bad ) ;
+				err_if( length > hoof_max_word_length , hoof_rc_error_word_long ) ;
+				for ( j = 0 ; j < length ; j += 1 )
+					{
+					err_passthrough( hoof_reader_byte( reader , & word[ j ] , & done ) ) ;
+					err_if( done , hoof_rc_error_file_bad ) ;
+					err_if( word[ j ] == '\0' , hoof_rc_error_word_bad ) ;
+					}
+				word[ length ] = '\0' ;
+				err_passthrough( hoof_word_verify( word ) ) ;
+				err_passthrough( hoof_intern_add( hoof , word , & words[ i ] ) ) ;
+				}
+			err_passthrough( hoof_load_records( reader , builder , words , count ) ) ;
+			// unloaded pages and pages copied on save need the dictionary later
+			hoof -> dictionary = words ;
+			hoof -> dictionary_count = count ;
+			words = NULL ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( new_words ) ;
+			// words past i were never read
+			hoof_dictionary_free( hoof , & words , i ) ;
+			return rc ;
+			}
+		static n hoof_load_records( struct hoof_reader * reader , struct hoof_builder * builder , struct hoof_intern * * words , n count )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			n done = 0 ;
+			n offset = 0 ;
+			n record = 0 ;
+			n words_in_value = 0 ;
+			n index = 0 ;
+			n j = 0 ;
+			// code
+			while ( builder -> finished == 0 )
+				{
+				offset = reader -> offset + reader -> index ;
+				err_passthrough( hoof_reader_number( reader , & record , & done ) ) ;
+				if ( done )
+					{
+					break ;
+					}
+				if ( record == hoof_record_out )
+					{
+					hoof_build_out( builder , reader -> offset + reader -> index ) ;
+					continue ;
+					}
+				err_if( record != hoof_record_right && record != hoof_record_down && record != hoof_record_in , hoof_rc_error_file_bad ) ;
+				builder -> offset = offset ;
+				err_passthrough( hoof_build_value( builder , record ) ) ;
+				err_passthrough( hoof_reader_number( reader , & words_in_value , & done ) ) ;
+				err_if( done , hoof_rc_error_file_bad ) ;
+				err_if( words_in_value > hoof_max_value_length , hoof_rc_error_value_long ) ;
+				for ( j = 0 ; j < words_in_value ; j += 1 )
+					{
+					err_passthrough( hoof_reader_number( reader , & index , & done ) ) ;
+					err_if( done || index >= count , hoof_rc_error_file_bad ) ;
+					err_passthrough( hoof_build_word( builder , words[ index ] -> text ) ) ;
+					}
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_dictionary_grow( struct hoof_dictionary * dictionary )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			b * * new_words = NULL ;
+			n * new_slots = NULL ;
+			n new_capacity = 0 ;
+			n i = 0 ;
+			// code
+			new_capacity = dictionary -> capacity * 2 ;
+			if ( new_capacity == 0 )
+				{
+				new_capacity = hoof_dictionary_capacity_initial ;
+				}
+			hoof_memory_malloc( new_words , b * , new_capacity ) ;
+			// twice as many slots as words keeps the probes short
+			hoof_memory_calloc( new_slots , n , new_capacity * 2 ) ;
+			for ( i = 0 ; i < dictionary -> count ; i += 1 )
+				{
+				new_words[ i ] = dictionary -> words[ i ] ;
+				}
+			hoof_memory_free( dictionary -> words ) ;
+			hoof_memory_free( dictionary -> slots ) ;
+			dictionary -> words = new_words ;
+			new_words = NULL ;
+			dictionary -> slots = new_slots ;
+			new_slots = NULL ;
+			dictionary -> capacity = new_capacity ;
+			dictionary -> slot_count = new_capacity * 2 ;
+			// put the words back in their new slots
+			for ( i = 0 ; i < dictionary -> count ; i += 1 )
+				{
+				dictionary -> slots[ hoof_dictionary_slot( dictionary , dictionary -> words[ i ] ) ] = i + 1 ;
+				}
+			// cleanup
+			cleanup:
+			hoof_memory_free( new_words ) ;
+			hoof_memory_free( new_slots ) ;
+			return rc ;
+			}
+		static n hoof_dictionary_slot( struct hoof_dictionary * dictionary , b * word )
+			{
+			// data
+			n slot = 0 ;
+			// code
+			slot = hoof_word_hash( word ) & ( dictionary -> slot_count - 1 ) ;
+			while ( dictionary -> slots[ slot ] != 0 && ! hoof_words_are_same( dictionary -> words[ dictionary -> slots[ slot ] - 1 ] , word ) )
+				{
+				slot = ( slot + 1 ) & ( dictionary -> slot_count - 1 ) ;
+				}
+			return slot ;
+			}
+		static n hoof_dictionary_add( struct hoof_dictionary * dictionary , b * word )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			n slot = 0 ;
+			// code
+			if ( dictionary -> count == dictionary -> capacity )
+				{
+				err_passthrough( hoof_dictionary_grow( dictionary ) ) ;
+				}
+			slot = hoof_dictionary_slot( dictionary , word ) ;
+			if ( dictionary -> slots[ slot ] == 0 )
+				{
+				dictionary -> words[ dictionary -> count ] = word ;
+				dictionary -> count += 1 ;
+				dictionary -> slots[ slot ] = dictionary -> count ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_dictionary_free( struct hoof * hoof , struct hoof_intern * * * dictionary_F , n count )
+			{
+			/*!	\brief Lets go of the interns of a binary file's words.
+				\param[in] hoof struct hoof context.
+				\param[in] dictionary_F The words, some can be null if it wasn't finished.
+				\param[in] count How many words it has.
+				\return void
+				*/
+			// data
+			n i = 0 ;
+			// code
+			if ( ( * dictionary_F ) == NULL )
+				{
+				return ;
+				}
+			for ( i = 0 ; i < count ; i += 1 )
+				{
+				if ( ( * dictionary_F )[ i ] != NULL )
+					{
+					hoof_intern_release( hoof , ( * dictionary_F )[ i ] ) ;
+					}
+				}
+			hoof_memory_free( ( * dictionary_F ) ) ;
+			}
+		static n hoof_save_flush( struct hoof_writer * writer )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			if ( writer -> fp == NULL )
+				{
+				// the whole file is in the buffer, this is only called once at the end
+				writer -> length = writer -> used ;
+				writer -> hash = hoof_hash_bytes( hoof_hash_start , writer -> buffer , writer -> used ) ;
+				goto cleanup ;
+				}
+			if ( writer -> used == 0 )
+				{
+				goto cleanup ;
+				}
+			err_if( hoof_hook_fwrite( writer -> buffer , 1 , writer -> used , writer -> fp ) != ( size_t ) writer -> used , hoof_rc_error_file ) ;
+			writer -> length += writer -> used ;
+			writer -> hash = hoof_hash_bytes( writer -> hash , writer -> buffer , writer -> used ) ;
+			writer -> used = 0 ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_save_reserve( struct hoof_writer * writer , n count )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			n size = writer -> size ;
+			b * buffer = NULL ;
+			n i = 0 ;
+			// code
+			if ( writer -> used + count <= writer -> size )
+				{
+				goto cleanup ;
+				}
+			if ( writer -> fp != NULL )
+				{
+				paranoid_err_if( count > writer -> size ) ;
+				err_passthrough( hoof_save_flush( writer ) ) ;
+				goto cleanup ;
+				}
+			// no file to write to yet, so the buffer grows
+			while ( writer -> used + count > size )
+				{
+				size *= 2 ;
+				}
+			hoof_memory_malloc( buffer , b , size ) ;
+			for ( i = 0 ; i < writer -> used ; i += 1 )
+				{
+				buffer[ i ] = writer -> buffer[ i ] ;
+				}
+			hoof_memory_free( writer -> buffer ) ;
+			writer -> buffer = buffer ;
+			buffer = NULL ;
+			writer -> size = size ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_save_bytes( struct hoof_writer * writer , b * bytes , n count )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			n i = 0 ;
+			b * buffer = NULL ;
+			// code
+			err_passthrough( hoof_save_reserve( writer , count ) ) ;
+			buffer = writer -> buffer + writer -> used ;
+			for ( i = 0 ; i < count ; i += 1 )
+				{
+				buffer[ i ] = bytes[ i ] ;
+				}
+			writer -> used += count ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_save_number( struct hoof_writer * writer , n number )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			b bytes[ 10 ] ;
+			n count = 0 ;
+			// code
+			paranoid_err_if( number < 0 ) ;
+			while ( number >= 0x80 )
+				{
+				bytes[ count ] = ( b ) ( ( number & 0x7f ) | 0x80 ) ;
+				count += 1 ;
+				number >>= 7 ;
+				}
+			bytes[ count ] = ( b ) number ;
+			count += 1 ;
+			err_passthrough( hoof_save_bytes( writer , bytes , count ) ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_save_word( struct hoof_writer *writer, b *word, n newline )
+			{
+			/* DATA */
+			n rc = hoof_rc_success;
 
-						/* go out */
-						err_passthrough( hoof_save_word( fp, ( b * ) "out", 1 ) );
+			n i = 0;
 
-						value = value->out->down;
+			b *buffer = null;
+
+
+			/* CODE */
+			while ( word[ i ] != '\0' )
+			{
+				i += 1;
+			}
+
+			/* the word and the space or newline after it go in the buffer together */
+			err_passthrough( hoof_save_reserve( writer, i + 1 ) );
+
+			buffer = writer->buffer + writer->used;
+			i = 0;
+			while ( word[ i ] != '\0' )
+			{
+				buffer[ i ] = word[ i ];
+				i += 1;
+			}
+
+			buffer[ i ] = newline ? '\n' : ' ';
+			writer->used += i + 1;
+
+
+			/* CLEANUP */
+			cleanup:
+
+			return rc;
+			}
+		static n hoof_save_value( struct hoof_writer *writer, struct hoof_value *value, n record )
+			{
+			/* DATA */
+			n rc = hoof_rc_success;
+
+			static b *directions[] = { ( b * ) "right", ( b * ) "down", ( b * ) "in" };
+
+			n i = 0;
+
+
+			/* CODE */
+			paranoid_err_if( value == null );
+			paranoid_err_if( value->sentinel );
+			paranoid_err_if( value->word_count < 0 || value->word_count > hoof_max_value_length );
+			paranoid_err_if( value->word_count > 0 && value->words == null );
+			paranoid_err_if( value->index_parent == null );
+			paranoid_err_if( record != hoof_record_right && record != hoof_record_down && record != hoof_record_in );
+
+			/* binary */
+			if ( writer->binary )
+			{
+				if ( writer->collecting )
+				{
+					for ( i = 0; i < value->word_count; i += 1 )
+					{
+						err_passthrough( hoof_dictionary_add( &( writer->dictionary ), value->words[ i ]->text ) );
 					}
+
+					goto cleanup;
+				}
+
+				err_passthrough( hoof_save_number( writer, record ) );
+				err_passthrough( hoof_save_number( writer, value->word_count ) );
+
+				for ( i = 0; i < value->word_count; i += 1 )
+				{
+					err_passthrough( hoof_save_number( writer, writer->dictionary.slots[ hoof_dictionary_slot( &( writer->dictionary ), value->words[ i ]->text ) ] - 1 ) );
 				}
+
+				goto cleanup;
 			}
 
-			fclose( fp );
-			fp = null;
+			/* text */
+			err_passthrough( hoof_save_word( writer, ( b * ) "new", 0 ) );
+			err_passthrough( hoof_save_word( writer, directions[ record ], 0 ) );
+
+			for ( i = 0; i < value->word_count; i += 1 )
+			{
+				if ( value->words[ i ]->keyword )
+				{
+					err_passthrough( hoof_save_word( writer, ( b * ) "literal", 0 ) );
+				}
 
-			err_if( hoof_hook_rename( ( char * ) temp_filename , ( char * ) hoof->filename ) != 0, hoof_rc_error_file );
+				err_passthrough( hoof_save_word( writer, value->words[ i ]->text, 0 ) );
+			}
 
-			temp_filename[ 0 ] = '\0';
+			err_passthrough( hoof_save_word( writer, ( b * ) "done", 1 ) );
 
 
 			/* CLEANUP */
 			cleanup:
-
-			if ( temp_filename[ 0 ] != '\0' )
-			{
-				remove( ( char * ) temp_filename );
-			}
-
-			if ( fp != null )
-			{
-				fclose( fp );
-				fp = null;
-			}
-
-			return rc;
+
+			return rc;
+			}
+		static n hoof_save_out( struct hoof_writer * writer )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			if ( writer -> collecting )
+				{
+				goto cleanup ;
+				}
+			if ( writer -> binary )
+				{
+				err_passthrough( hoof_save_number( writer , hoof_record_out ) ) ;
+				}
+			else
+				{
+				err_passthrough( hoof_save_word( writer , ( b * ) "out" , 1 ) ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_page_dirty( struct hoof * hoof , struct hoof_value * owner )
+			{
+			/*!	\brief Marks that a page changed, along with every page it's inside of.
+				\param[in] hoof struct hoof context.
+				\param[in] owner Value whose page changed, null for the root page.
+				\return void
+				*/
+			// code
+			// pages the loader builds are the same as the file
+			if ( hoof -> building )
+				{
+				return ;
+				}
+			hoof -> modified = 1 ;
+			// the search results may have values that aren't there anymore
+			hoof -> search_stale = 1 ;
+			// the page's dig index doesn't know about the change, so dig builds it again if it needs it
+			if ( owner == NULL )
+				{
+				// the root page doesn't have a head yet while hoof_page_init is making it
+				if ( hoof -> root != NULL )
+					{
+					hoof_dig_index_free( hoof , hoof -> root ) ;
+					}
+				}
+			else if ( owner -> in != NULL )
+				{
+				hoof_dig_index_free( hoof , owner -> in ) ;
+				}
+			// a dirty page is always inside dirty pages, so we can stop at the first one
+			// a page that's being made has no in yet, it's new so it can't be copied anyway
+			while ( owner != NULL && ( owner -> in == NULL || owner -> in -> page -> dirty == 0 ) )
+				{
+				if ( owner -> in != NULL )
+					{
+					owner -> in -> page -> dirty = 1 ;
+					}
+				owner = owner -> out ;
+				}
+			}
+		static n hoof_save_record( struct hoof_writer * writer , struct hoof_value * page , n offset , n length )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_saved * new_saved = NULL ;
+			n new_capacity = 0 ;
+			n i = 0 ;
+			// code
+			if ( writer -> saved_count == writer -> saved_capacity )
+				{
+				new_capacity = writer -> saved_capacity * 2 ;
+				if ( new_capacity == 0 )
+					{
+					new_capacity = hoof_saved_capacity_initial ;
+					}
+				hoof_memory_malloc( new_saved , struct hoof_saved , new_capacity ) ;
+				for ( i = 0 ; i < writer -> saved_count ; i += 1 )
+					{
+					new_saved[ i ] = writer -> saved[ i ] ;
+					}
+				hoof_memory_free( writer -> saved ) ;
+				writer -> saved = new_saved ;
+				new_saved = NULL ;
+				writer -> saved_capacity = new_capacity ;
+				}
+			writer -> saved[ writer -> saved_count ] . page = page ;
+			writer -> saved[ writer -> saved_count ] . offset = offset ;
+			writer -> saved[ writer -> saved_count ] . length = length ;
+			writer -> saved[ writer -> saved_count ] . parent = writer -> open ;
+			writer -> saved_count += 1 ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( new_saved ) ;
+			return rc ;
+			}
+		static n hoof_save_open( struct hoof_writer * writer , struct hoof_value * page )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			if ( writer -> collecting )
+				{
+				goto cleanup ;
+				}
+			// how long the page is gets filled in when we write its out
+			err_passthrough( hoof_save_record( writer , page , writer -> length + writer -> used , 0 ) ) ;
+			writer -> open = writer -> saved_count - 1 ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_save_close( struct hoof_writer * writer )
+			{
+			// data
+			struct hoof_saved * saved = NULL ;
+			n end = 0 ;
+			// code
+			if ( writer -> collecting )
+				{
+				return ;
+				}
+			// in the text format the page ends before the newline after out
+			end = writer -> length + writer -> used ;
+			if ( ! writer -> binary )
+				{
+				end -= 1 ;
+				}
+			saved = & writer -> saved[ writer -> open ] ;
+			saved -> length = end - saved -> offset ;
+			writer -> open = saved -> parent ;
+			}
+		static n hoof_save_shift( struct hoof_writer * writer , struct hoof_value * page , n delta )
+			{
+			/*!	\brief Moves the pages inside a copied page to where they are in the new file.
+				\param[in] writer Where the pages are recorded.
+				\param[in] page The copied page.
+				\param[in] delta How far the copied page moved.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * value = NULL ;
+			// code
+			value = page -> down ;
+			while ( 1 )
+				{
+				if ( ! value -> sentinel )
+					{
+					if ( value -> in != NULL && value -> in -> page -> offset != 0 )
+						{
+						err_passthrough( hoof_save_record( writer , value -> in , value -> in -> page -> offset - 1 + delta , value -> in -> page -> length ) ) ;
+						}
+					if ( value -> in != NULL && value -> in -> page -> unloaded == 0 )
+						{
+						value = value -> in -> down ;
+						}
+					else
+						{
+						value = value -> down ;
+						}
+					continue ;
+					}
+				// a tail, so we go back out unless it's the copied page's
+				if ( value -> out == page -> out )
+					{
+					break ;
+					}
+				value = value -> out -> down ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_save_copy( struct hoof_writer * writer , struct hoof_value * page , n * copied )
+			{
+			/*!	\brief Copies a page straight from the file being replaced, if it hasn't changed.
+				\param[in] writer Where the page goes.
+				\param[in] page The page.
+				\param[out] copied Set if the page was copied, so it doesn't need to be written.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			n start = 0 ;
+			n remaining = 0 ;
+			n count = 0 ;
+			b newline = '\n' ;
+			// code
+			( * copied ) = 0 ;
+			if ( writer -> source == NULL || page -> page -> dirty || page -> page -> offset == 0 || page -> page -> length == 0 )
+				{
+				goto cleanup ;
+				}
+			( * copied ) = 1 ;
+			// the first pass only has to know the file's words are still used
+			if ( writer -> collecting )
+				{
+				writer -> copying = 1 ;
+				goto cleanup ;
+				}
+			start = writer -> length + writer -> used ;
+			err_passthrough( hoof_save_record( writer , page , start , page -> page -> length ) ) ;
+			err_passthrough( hoof_save_shift( writer , page , start - ( page -> page -> offset - 1 ) ) ) ;
+			err_if( fseek( writer -> source , ( long ) ( page -> page -> offset - 1 ) , SEEK_SET ) != 0 , hoof_rc_error_file ) ;
+			remaining = page -> page -> length ;
+			while ( remaining > 0 )
+				{
+				count = remaining ;
+				if ( count > writer -> size )
+					{
+					count = writer -> size ;
+					}
+				err_passthrough( hoof_save_reserve( writer , count ) ) ;
+				err_if( hoof_hook_fread( writer -> buffer + writer -> used , 1 , count , writer -> source ) != ( size_t ) count , hoof_rc_error_file ) ;
+				writer -> used += count ;
+				remaining -= count ;
+				}
+			if ( ! writer -> binary )
+				{
+				err_passthrough( hoof_save_bytes( writer , & newline , 1 ) ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_save_seed( struct hoof * hoof , struct hoof_writer * writer )
+			{
+			/*!	\brief Puts the file's words at the front of the dictionary.
+				\param[in] hoof struct hoof context.
+				\param[in] writer Has the words of the pages that will be written.
+				\return n
+
+				Copied pages keep the word numbers they had in the file.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_dictionary dictionary = { NULL , 0 , 0 , NULL , 0 } ;
+			n i = 0 ;
+			// code
+			for ( i = 0 ; i < hoof -> dictionary_count ; i += 1 )
+				{
+				err_passthrough( hoof_dictionary_add( & dictionary , hoof -> dictionary[ i ] -> text ) ) ;
+				}
+			for ( i = 0 ; i < writer -> dictionary . count ; i += 1 )
+				{
+				err_passthrough( hoof_dictionary_add( & dictionary , writer -> dictionary . words[ i ] ) ) ;
+				}
+			hoof_memory_free( writer -> dictionary . words ) ;
+			hoof_memory_free( writer -> dictionary . slots ) ;
+			writer -> dictionary = dictionary ;
+			dictionary . words = NULL ;
+			dictionary . slots = NULL ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( dictionary . words ) ;
+			hoof_memory_free( dictionary . slots ) ;
+			return rc ;
+			}
+		static n hoof_save_dictionary( struct hoof * hoof , struct hoof_writer * writer , struct hoof_intern * * * dictionary )
+			{
+			/*!	\brief Gets the interns of the dictionary that was written, the way hoof_load_binary keeps them.
+				\param[in] hoof struct hoof context.
+				\param[in] writer Has the dictionary that was written.
+				\param[out] dictionary The words, null if the file is text or has no words.
+					If this fails the words gotten so far are left in it for hoof_dictionary_free.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			n i = 0 ;
+			// code
+			if ( ! writer -> binary || writer -> dictionary . count == 0 )
+				{
+				goto cleanup ;
+				}
+			hoof_memory_calloc( ( * dictionary ) , struct hoof_intern * , writer -> dictionary . count ) ;
+			for ( i = 0 ; i < writer -> dictionary . count ; i += 1 )
+				{
+				err_passthrough( hoof_intern_add( hoof , writer -> dictionary . words[ i ] , & ( * dictionary )[ i ] ) ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_save_apply( struct hoof_writer * writer )
+			{
+			// data
+			n i = 0 ;
+			// code
+			for ( i = 0 ; i < writer -> saved_count ; i += 1 )
+				{
+				writer -> saved[ i ] . page -> page -> offset = writer -> saved[ i ] . offset + 1 ;
+				writer -> saved[ i ] . page -> page -> length = writer -> saved[ i ] . length ;
+				writer -> saved[ i ] . page -> page -> dirty = 0 ;
+				}
+			}
+		static n hoof_save_walk( struct hoof *hoof, struct hoof_writer *writer )
+			{
+			/* DATA */
+			n rc = hoof_rc_success;
+
+			struct hoof_value *value = null;
+
+			n first = 1;
+			n copied = 0;
+
+
+			/* CODE */
+			value = hoof->root->down;
+
+			paranoid_err_if( value == null );
+			paranoid_err_if( value->sentinel );
+			paranoid_err_if( ! value->up->sentinel );
+
+			while ( value != null )
+			{
+				paranoid_err_if( value->up->down != value );
+				paranoid_err_if( value->down->up != value );
+				paranoid_err_if( value->out != value->up->out );
+				paranoid_err_if( value->out != value->down->out );
+
+				if ( first )
+				{
+					err_passthrough( hoof_save_value( writer, value, hoof_record_right ) );
+					first = 0;
+				}
+				else
+				{
+					err_passthrough( hoof_save_value( writer, value, hoof_record_down ) );
+				}
+
+				/* go most in */
+				while ( value->in != null )
+				{
+					/* a page that hasn't changed since the file was written is copied straight from it */
+					err_passthrough( hoof_save_copy( writer, value->in, &copied ) );
+					if ( copied )
+					{
+						break;
+					}
+
+					/* any other page has to be loaded to be written out */
+					err_passthrough( hoof_page_load( hoof, value ) );
+
+					paranoid_err_if( value->in->out != value );
+					paranoid_err_if( ! value->in->sentinel );
+					paranoid_err_if( value->in->down == null );
+
+					value = value->in->down;
+
+					paranoid_err_if( value->up->down != value );
+					paranoid_err_if( value->down->up != value );
+					paranoid_err_if( value->out != value->up->out );
+					paranoid_err_if( value->out != value->down->out );
+
+					err_passthrough( hoof_save_open( writer, value->up ) );
+					err_passthrough( hoof_save_value( writer, value, hoof_record_in ) );
+				}
+
+				/* go down */
+				value = value->down;
+
+				paranoid_err_if( value->up->down != value );
+				paranoid_err_if( value->down != null && value->down->up != value );
+				paranoid_err_if( value->out != value->up->out );
+				paranoid_err_if( value->down != null && value->out != value->down->out );
+
+				/* if tail */
+				if ( value->sentinel )
+				{
+					paranoid_err_if( value->down != null );
+
+					/* while tail */
+					while ( value->sentinel )
+					{
+						/* if we cant go out */
+						if ( value->out == null )
+						{
+							/* we're done, we use value to break all loops */
+							value = null;
+							break;
+						}
+
+						/* go out */
+						err_passthrough( hoof_save_out( writer ) );
+						hoof_save_close( writer );
+
+						value = value->out->down;
+					}
+				}
+			}
+
+
+			/* CLEANUP */
+			cleanup:
+
+			return rc;
+			}
+		static n hoof_save_contents( struct hoof * hoof , struct hoof_writer * writer )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			n i = 0 ;
+			b length = 0 ;
+			// code
+			if ( writer -> binary )
+				{
+				// first pass finds all the distinct words
+				writer -> collecting = 1 ;
+				err_passthrough( hoof_save_walk( hoof , writer ) ) ;
+				writer -> collecting = 0 ;
+				if ( writer -> copying )
+					{
+					err_passthrough( hoof_save_seed( hoof , writer ) ) ;
+					}
+				err_passthrough( hoof_save_bytes( writer , ( b * ) hoof_binary_magic , hoof_binary_magic_length ) ) ;
+				err_passthrough( hoof_save_number( writer , hoof_binary_version ) ) ;
+				err_passthrough( hoof_save_number( writer , writer -> dictionary . count ) ) ;
+				for ( i = 0 ; i < writer -> dictionary . count ; i += 1 )
+					{
+					length = ( b ) hoof_word_length( writer -> dictionary . words[ i ] ) ;
+					err_passthrough( hoof_save_bytes( writer , & length , 1 ) ) ;
+					err_passthrough( hoof_save_bytes( writer , writer -> dictionary . words[ i ] , length ) ) ;
+					}
+				}
+			err_passthrough( hoof_save_walk( hoof , writer ) ) ;
+			err_passthrough( hoof_save_flush( writer ) ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_save_filename( struct hoof * hoof , b * temp_filename )
+			{
+			// data
+			n i = 0 ;
+			// code
+			// the temp file is the filename with a dot in front
+			temp_filename[ 0 ] = '.' ;
+			while ( hoof -> filename[ i ] != '\0' )
+				{
+				temp_filename[ i + 1 ] = hoof -> filename[ i ] ;
+				i += 1 ;
+				}
+			temp_filename[ i + 1 ] = '\0' ;
+			}
+		static n hoof_save_write( struct hoof * hoof )
+			{
+			/*!	\brief Writes save_buffer to save_fp and renames it over the file.
+				\param[in] hoof struct hoof context.
+				\return n
+
+				Only touches save_fp, save_buffer and the files, so it can run while hoof_do keeps
+				editing the tree. It doesn't call the file hooks or hoof_hook_log either, since
+				hoof_do keeps calling the hooks on the other thread, hoof_save_wait logs its error.
+				*/
+			// data
+			// +1 for null +1 for dot at beginning
+			b temp_filename[ hoof_max_word_length + 2 ] = "" ;
+			b journal_filename[ hoof_max_word_length + hoof_journal_suffix_length + 1 ] ;
+			size_t written = 0 ;
+			int closed = 0 ;
+			// code
+			hoof_save_filename( hoof , temp_filename ) ;
+			written = fwrite( hoof -> save_buffer , 1 , hoof -> save_length , hoof -> save_fp ) ;
+			closed = fclose( hoof -> save_fp ) ;
+			hoof -> save_fp = NULL ;
+			if ( written != ( size_t ) hoof -> save_length || closed != 0 || rename( ( char * ) temp_filename , ( char * ) hoof -> filename ) != 0 )
+				{
+				remove( ( char * ) temp_filename ) ;
+				return hoof_rc_error_file ;
+				}
+			hoof_journal_filename( hoof , journal_filename ) ;
+			remove( ( char * ) journal_filename ) ;
+			return hoof_rc_success ;
+			}
+		#ifdef hoof_use_threads
+			static void * hoof_save_thread( void * hoof )
+				{
+				// code
+				( ( struct hoof * ) hoof ) -> save_rc = hoof_save_write( ( struct hoof * ) hoof ) ;
+				return NULL ;
+				}
+		#endif
+		static n hoof_save_start( struct hoof * hoof )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// +1 for null +1 for dot at beginning
+			b temp_filename[ hoof_max_word_length + 2 ] = "" ;
+			// code
+			// the temp file is opened on this thread, so the file hooks are only called from here
+			hoof_save_filename( hoof , temp_filename ) ;
+			hoof -> save_rc = hoof_rc_error_file ;
+			hoof -> save_fp = hoof_hook_fopen( ( char * ) temp_filename , "w+" ) ;
+			if ( hoof -> save_fp != NULL )
+				{
+				#ifdef hoof_use_threads
+					if ( pthread_create( & hoof -> save_thread , NULL , hoof_save_thread , hoof ) == 0 )
+						{
+						hoof -> save_threaded = 1 ;
+						goto cleanup ;
+						}
+				#endif
+				// without a thread we write it right here
+				hoof -> save_rc = hoof_save_write( hoof ) ;
+				}
+			err_passthrough( hoof_save_wait( hoof ) ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_save_wait( struct hoof * hoof )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			if ( hoof -> save_buffer == NULL )
+				{
+				goto cleanup ;
+				}
+			#ifdef hoof_use_threads
+				if ( hoof -> save_threaded )
+					{
+					pthread_join( hoof -> save_thread , NULL ) ;
+					hoof -> save_threaded = 0 ;
+					}
+			#endif
+			hoof_memory_free( hoof -> save_buffer ) ;
+			hoof -> save_length = 0 ;
+			if ( hoof -> save_rc != hoof_rc_success )
+				{
+				// the file on disk is older than we thought, so the next save rewrites it
+				hoof -> journal_compact = 1 ;
+				hoof -> modified = 1 ;
+				}
+			// the save thread doesn't log, so what it ran in to is logged here
+			err_if( hoof -> save_rc != hoof_rc_success , hoof -> save_rc ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_save( struct hoof *hoof )
+			{
+			/* DATA */
+			n rc = hoof_rc_success;
+
+			/* +1 for null +1 for dot at beginning */
+			b temp_filename[ hoof_max_word_length + 2 ] = "";
+			b journal_filename[ hoof_max_word_length + hoof_journal_suffix_length + 1 ];
+
+			struct hoof_writer writer = { null, null, hoof_write_buffer_size, 0, 0, 0, { null, 0, 0, null, 0 }, 0, hoof_hash_start, null, 0, null, 0, 0, -1 };
+
+			struct hoof_intern **dictionary = null;
+
+
+			/* CODE */
+			/* only one save is written at a time */
+			err_passthrough( hoof_save_wait( hoof ) );
+
+			/* nothing changed, so the file and journal already have everything */
+			if ( hoof->modified == 0 && hoof->journal_compact == 0 )
+			{
+				goto cleanup;
+			}
+
+			/* with a journal we only append the edits, until the journal gets too big */
+			if (    hoof_journaling( hoof )
+				 && hoof->journal_size + hoof->journal_length <= hoof_journal_max_size
+			   )
+			{
+				err_passthrough( hoof_journal_save( hoof ) );
+				hoof->modified = 0;
+				goto cleanup;
+			}
+
+			hoof_memory_malloc( writer.buffer, b, hoof_write_buffer_size );
+
+			writer.binary = hoof->binary;
+
+			/* in the background we build the whole file in memory, then write it on another thread */
+			if ( hoof->options & hoof_option_background )
+			{
+				err_passthrough( hoof_save_contents( hoof, &writer ) );
+
+				hoof->save_buffer = writer.buffer;
+				hoof->save_length = writer.length;
+				writer.buffer = null;
+
+				/* the file might not be written, so pages aren't copied until a save finishes on this thread */
+				hoof->copy_pages = 0;
+			}
+			else
+			{
+				/* pages that haven't changed are copied from the file we're replacing */
+				if ( hoof->copy_pages && writer.binary == hoof->file_binary )
+				{
+					writer.source = hoof_hook_fopen( ( char * ) hoof->filename, "r" );
+					err_if( writer.source == null, hoof_rc_error_file );
+				}
+
+				/* open temp filename */
+				hoof_save_filename( hoof, temp_filename );
+
+				writer.fp = hoof_hook_fopen( ( char * ) temp_filename, "w+" );
+				err_if( writer.fp == null, hoof_rc_error_file );
+
+				/* write file */
+				err_passthrough( hoof_save_contents( hoof, &writer ) );
+
+				fclose( writer.fp );
+				writer.fp = null;
+
+				err_passthrough( hoof_save_dictionary( hoof, &writer, &dictionary ) );
+
+				if ( writer.source != null )
+				{
+					fclose( writer.source );
+					writer.source = null;
+				}
+
+				err_if( hoof_hook_rename( ( char * ) temp_filename , ( char * ) hoof->filename ) != 0, hoof_rc_error_file );
+
+				temp_filename[ 0 ] = '\0';
+
+				hoof_journal_filename( hoof, journal_filename );
+				remove( ( char * ) journal_filename );
+
+				/* pages now know where they are in the new file, and unloaded pages read its dictionary */
+				hoof_save_apply( &writer );
+
+				hoof_dictionary_free( hoof, &(hoof->dictionary), hoof->dictionary_count );
+				hoof->dictionary = dictionary;
+				hoof->dictionary_count = ( dictionary == null ) ? 0 : writer.dictionary.count;
+				dictionary = null;
+
+				hoof->copy_pages = 1;
+			}
+
+			/* the file has every edit now, so the journal starts over */
+			hoof->file_binary = writer.binary;
+			hoof->base_length = writer.length;
+			hoof->base_hash = writer.hash;
+
+			hoof->journal_length = 0;
+			hoof->journal_size = 0;
+			hoof->journal_compact = 0;
+
+			hoof->modified = 0;
+
+			if ( hoof->save_buffer != null )
+			{
+				err_passthrough( hoof_save_start( hoof ) );
+			}
+
+
+			/* CLEANUP */
+			cleanup:
+
+			hoof_memory_free( writer.buffer );
+			hoof_memory_free( writer.dictionary.words );
+			hoof_memory_free( writer.dictionary.slots );
+			hoof_memory_free( writer.saved );
+			hoof_dictionary_free( hoof, &dictionary, writer.dictionary.count );
+
+			if ( writer.source != null )
+			{
+				fclose( writer.source );
+				writer.source = null;
+			}
+
+			if ( temp_filename[ 0 ] != '\0' )
+			{
+				remove( ( char * ) temp_filename );
+			}
+
+			if ( writer.fp != null )
+			{
+				fclose( writer.fp );
+				writer.fp = null;
+			}
+
+			return rc;
+			}
+	// journal
+		/*	the journal is a text file of edits, one per line
+				journal length hash
+					of the file the edits go on top of, so a journal left behind by an older file is ignored
+				clear path
+				value path
+					a new empty value, at path once it's inserted
+				unvalue path
+				word path position word
+					a new word, at position once it's inserted
+				unword path position
+				move path path
+					from where the value is, to where it ends up
+			a path is how many pages deep the value is, then the value's index in each page starting from the root page
+			positions of words start at 1
+			*/
+		static void hoof_journal_filename( struct hoof * hoof , b * journal_filename )
+			{
+			// data
+			n i = 0 ;
+			n j = 0 ;
+			b * suffix = ( b * ) hoof_journal_suffix ;
+			// code
+			while ( hoof -> filename[ i ] != '\0' )
+				{
+				journal_filename[ i ] = hoof -> filename[ i ] ;
+				i += 1 ;
+				}
+			for ( j = 0 ; j <= hoof_journal_suffix_length ; j += 1 )
+				{
+				journal_filename[ i + j ] = suffix[ j ] ;
+				}
+			}
+		static n hoof_journal_add( struct hoof * hoof , b * bytes , n count )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			b * new_journal = NULL ;
+			n new_capacity = 0 ;
+			n i = 0 ;
+			// code
+			if ( ! hoof_journaling( hoof ) )
+				{
+				goto cleanup ;
+				}
+			if ( hoof -> journal_length + count > hoof -> journal_capacity )
+				{
+				new_capacity = hoof -> journal_capacity ;
+				if ( new_capacity == 0 )
+					{
+					new_capacity = hoof_journal_capacity_initial ;
+					}
+				while ( hoof -> journal_length + count > new_capacity )
+					{
+					new_capacity *= 2 ;
+					}
+				hoof_memory_malloc( new_journal , b , new_capacity ) ;
+				for ( i = 0 ; i < hoof -> journal_length ; i += 1 )
+					{
+					new_journal[ i ] = hoof -> journal[ i ] ;
+					}
+				hoof_memory_free( hoof -> journal ) ;
+				hoof -> journal = new_journal ;
+				new_journal = NULL ;
+				hoof -> journal_capacity = new_capacity ;
+				}
+			for ( i = 0 ; i < count ; i += 1 )
+				{
+				hoof -> journal[ hoof -> journal_length + i ] = bytes[ i ] ;
+				}
+			hoof -> journal_length += count ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( new_journal ) ;
+			// an edit missing from the journal means the next save has to rewrite the whole file
+			if ( rc != hoof_rc_success )
+				{
+				hoof -> journal_compact = 1 ;
+				}
+			return rc ;
+			}
+		static n hoof_journal_text( struct hoof * hoof , b * text )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			b space = ' ' ;
+			// code
+			err_passthrough( hoof_journal_add( hoof , text , hoof_word_length( text ) ) ) ;
+			err_passthrough( hoof_journal_add( hoof , & space , 1 ) ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_journal_number( struct hoof * hoof , n number )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			b text[ hoof_int_max_string_length + 1 ] ;
+			// code
+			text[ hoof_number_text( number , text ) ] = '\0' ;
+			err_passthrough( hoof_journal_text( hoof , text ) ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_journal_path( struct hoof * hoof , struct hoof_value * value )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * ancestor = NULL ;
+			n depth = 0 ;
+			n level = 0 ;
+			n i = 0 ;
+			// code
+			if ( ! hoof_journaling( hoof ) )
+				{
+				goto cleanup ;
+				}
+			for ( ancestor = value ; ancestor != NULL ; ancestor = ancestor -> out )
+				{
+				depth += 1 ;
+				}
+			err_passthrough( hoof_journal_number( hoof , depth ) ) ;
+			// root page first, so start with the ancestor furthest out
+			for ( level = depth - 1 ; level >= 0 ; level -= 1 )
+				{
+				ancestor = value ;
+				for ( i = 0 ; i < level ; i += 1 )
+					{
+					ancestor = ancestor -> out ;
+					}
+				err_passthrough( hoof_journal_number( hoof , hoof_index_of( ancestor ) ) ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_journal_end( struct hoof * hoof )
+			{
+			// the space after the last word of the edit becomes its newline
+			if ( hoof_journaling( hoof ) && hoof -> journal_length > 0 )
+				{
+				hoof -> journal[ hoof -> journal_length - 1 ] = '\n' ;
+				}
+			}
+		static n hoof_journal_value_edit( struct hoof * hoof , b * op , struct hoof_value * value )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			if ( ! hoof_journaling( hoof ) )
+				{
+				goto cleanup ;
+				}
+			err_passthrough( hoof_journal_text( hoof , op ) ) ;
+			err_passthrough( hoof_journal_path( hoof , value ) ) ;
+			hoof_journal_end( hoof ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_journal_word_edit( struct hoof * hoof , b * op , struct hoof_value * value , n index )
+			{
+			/*!	\brief Records adding or removing a word.
+				\param[in] hoof struct hoof context.
+				\param[in] op "word" after a word was inserted, "unword" before a word is deleted.
+				\param[in] value Value the word is in.
+				\param[in] index Where the word is in value. Nothing is recorded if there's no word there.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			if ( ! hoof_journaling( hoof ) || index < 0 || index >= value -> word_count )
+				{
+				goto cleanup ;
+				}
+			// the journal counts words from 1
+			err_passthrough( hoof_journal_text( hoof , op ) ) ;
+			err_passthrough( hoof_journal_path( hoof , value ) ) ;
+			err_passthrough( hoof_journal_number( hoof , index + 1 ) ) ;
+			if ( hoof_words_are_same( op , ( b * ) "word" ) )
+				{
+				err_passthrough( hoof_journal_text( hoof , value -> words[ index ] -> text ) ) ;
+				}
+			hoof_journal_end( hoof ) ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_journal_save( struct hoof * hoof )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			b journal_filename[ hoof_max_word_length + hoof_journal_suffix_length + 1 ] ;
+			b header[ 64 ] ;
+			n length = 0 ;
+			FILE * fp = NULL ;
+			// code
+			if ( hoof -> journal_length == 0 )
+				{
+				goto cleanup ;
+				}
+			hoof_journal_filename( hoof , journal_filename ) ;
+			if ( hoof -> journal_size == 0 )
+				{
+				// a new journal starts by saying which file it goes with
+				fp = hoof_hook_fopen( ( char * ) journal_filename , "w" ) ;
+				err_if( fp == NULL , hoof_rc_error_file ) ;
+				length = 0 ;
+				header[ length ] = '\0' ;
+				while ( ( ( b * ) "journal " )[ length ] != '\0' )
+					{
+					header[ length ] = ( ( b * ) "journal " )[ length ] ;
+					length += 1 ;
+					}
+				length += hoof_number_text( hoof -> base_length , header + length ) ;
+				header[ length ] = ' ' ;
+				length += 1 ;
+				length += hoof_number_text( hoof -> base_hash , header + length ) ;
+				header[ length ] = '\n' ;
+				length += 1 ;
+				err_if( hoof_hook_fwrite( header , 1 , length , fp ) != ( size_t ) length , hoof_rc_error_file ) ;
+				hoof -> journal_size = length ;
+				}
+			else
+				{
+				fp = hoof_hook_fopen( ( char * ) journal_filename , "a" ) ;
+				err_if( fp == NULL , hoof_rc_error_file ) ;
+				}
+			err_if( hoof_hook_fwrite( hoof -> journal , 1 , hoof -> journal_length , fp ) != ( size_t ) hoof -> journal_length , hoof_rc_error_file ) ;
+			hoof -> journal_size += hoof -> journal_length ;
+			hoof -> journal_length = 0 ;
+			// cleanup
+			cleanup:
+			if ( fp != NULL )
+				{
+				fclose( fp ) ;
+				fp = NULL ;
+				}
+			// the journal might end partway through an edit now, so don't add to it again
+			if ( rc != hoof_rc_success )
+				{
+				hoof -> journal_compact = 1 ;
+				}
+			return rc ;
+			}
+		static n hoof_journal_load( struct hoof * hoof )
+			{
+			/*!	\brief Replays the journal on top of the file that was just loaded.
+				\param[in] hoof struct hoof context.
+				\return n
+
+				A missing journal, or one written for a different version of the file, is ignored
+				and will be started over by the next save.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_reader reader = { NULL , NULL , 0 , 0 , 0 , 0 } ;
+			b journal_filename[ hoof_max_word_length + hoof_journal_suffix_length + 1 ] ;
+			b word[ hoof_max_word_length + 1 ] ;
+			n done = 0 ;
+			n length = 0 ;
+			n hash = 0 ;
+			// code
+			hoof_journal_filename( hoof , journal_filename ) ;
+			reader . fp = hoof_hook_fopen( ( char * ) journal_filename , "r" ) ;
+			if ( reader . fp == NULL )
+				{
+				goto cleanup ;
+				}
+			hoof_memory_malloc( reader . buffer , b , hoof_read_buffer_size ) ;
+			err_passthrough( hoof_journal_read_word( & reader , word , & done ) ) ;
+			if ( done || ! hoof_words_are_same( word , ( b * ) "journal" ) )
+				{
+				goto cleanup ;
+				}
+			err_passthrough( hoof_journal_read_number( & reader , & length , & done ) ) ;
+			err_passthrough( hoof_journal_read_number( & reader , & hash , & done ) ) ;
+			if ( done || length != hoof -> base_length || hash != hoof -> base_hash )
+				{
+				goto cleanup ;
+				}
+			while ( 1 )
+				{
+				err_passthrough( hoof_journal_read_word( & reader , word , & done ) ) ;
+				if ( done )
+					{
+					break ;
+					}
+				err_passthrough( hoof_journal_replay( hoof , & reader , word , & done ) ) ;
+				if ( done )
+					{
+					// the last edit was cut short, so it's left out and the next save rewrites the file
+					hoof -> journal_compact = 1 ;
+					break ;
+					}
+				}
+			hoof -> journal_size = reader . offset ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( reader . buffer ) ;
+			if ( reader . fp != NULL )
+				{
+				fclose( reader . fp ) ;
+				reader . fp = NULL ;
+				}
+			return rc ;
+			}
+		static n hoof_journal_read_word( struct hoof_reader * reader , b * word , n * done )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			// code
+			while ( 1 )
+				{
+				err_passthrough( hoof_reader_word( reader , word , done ) ) ;
+				if ( * done )
+					{
+					break ;
+					}
+				err_passthrough( hoof_word_verify( word ) ) ;
+				if ( word[ 0 ] != '\0' )
+					{
+					break ;
+					}
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_journal_read_number( struct hoof_reader * reader , n * number , n * done )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			b word[ hoof_max_word_length + 1 ] ;
+			n i = 0 ;
+			// code
+			( * number ) = 0 ;
+			err_passthrough( hoof_journal_read_word( reader , word , done ) ) ;
+			if ( * done )
+				{
+				goto cleanup ;
+				}
+			// hoof_word_verify already made sure a number fits
+			err_if( word[ 0 ] < '0' || word[ 0 ] > '9' , hoof_rc_error_file_bad ) ;
+			for ( i = 0 ; word[ i ] != '\0' ; i += 1 )
+				{
+				( * number ) = ( * number ) * 10 + ( word[ i ] - '0' ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_journal_read_path( struct hoof_reader * reader , n * * path_A , n * depth , n * done )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			n * new_path = NULL ;
+			n i = 0 ;
+			// code
+			err_passthrough( hoof_journal_read_number( reader , depth , done ) ) ;
+			if ( * done )
+				{
+				goto cleanup ;
+				}
+			err_if( ( * depth ) < 1 || ( * depth ) > hoof_journal_depth_max , hoof_rc_error_file_bad ) ;
+			hoof_memory_malloc( new_path , n , ( * depth ) ) ;
+			for ( i = 0 ; i < ( * depth ) ; i += 1 )
+				{
+				err_passthrough( hoof_journal_read_number( reader , & new_path[ i ] , done ) ) ;
+				if ( * done )
+					{
+					goto cleanup ;
+					}
+				}
+			// give back
+			( * path_A ) = new_path ;
+			new_path = NULL ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( new_path ) ;
+			return rc ;
+			}
+		static n hoof_journal_find( struct hoof * hoof , n * path , n depth , struct hoof_value * * parent , struct hoof_value * * value )
+			{
+			/*!	\brief Follows a path.
+				\param[in] hoof struct hoof context.
+				\param[in] path Index of the value in each page.
+				\param[in] depth How many indexes are in path.
+				\param[out] parent Value whose page has the last index, null for the root page.
+				\param[out] value Value at the last index, null if that page doesn't have one.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * page = NULL ;
+			n level = 0 ;
+			// code
+			( * parent ) = NULL ;
+			( * value ) = NULL ;
+			for ( level = 0 ; level < depth ; level += 1 )
+				{
+				if ( level > 0 )
+					{
+					err_if( ( * value ) == NULL , hoof_rc_error_file_bad ) ;
+					( * parent ) = ( * value ) ;
+					}
+				( * value ) = NULL ;
+				page = hoof -> root ;
+				if ( ( * parent ) != NULL )
+					{
+					err_passthrough( hoof_page_load( hoof , ( * parent ) ) ) ;
+					page = ( * parent ) -> in ;
+					}
+				if ( page == NULL )
+					{
+					continue ;
+					}
+				( * value ) = hoof_index_value( page , path[ level ] ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_journal_place( struct hoof * hoof , struct hoof_value * parent , n index , n create_empty , struct hoof_value * * before )
+			{
+			/*!	\brief Finds where a value goes so it ends up at index.
+				\param[in] hoof struct hoof context.
+				\param[in] parent Value whose page it goes in, null for the root page.
+				\param[in] index Where in the page it goes.
+				\param[in] create_empty If parent doesn't have a page, whether the new page gets an empty value.
+				\param[out] before Value or page head the value goes after. Null if the new page already has its empty value.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * page = NULL ;
+			// code
+			( * before ) = NULL ;
+			page = hoof -> root ;
+			if ( parent != NULL && parent -> in == NULL )
+				{
+				err_if( index != 0 , hoof_rc_error_file_bad ) ;
+				err_passthrough( hoof_page_init( hoof , parent , create_empty , & page ) ) ;
+				if ( ! create_empty )
+					{
+					( * before ) = page ;
+					}
+				goto cleanup ;
+				}
+			if ( parent != NULL )
+				{
+				err_passthrough( hoof_page_load( hoof , parent ) ) ;
+				page = parent -> in ;
+				}
+			( * before ) = page ;
+			if ( index > 0 )
+				{
+				( * before ) = hoof_index_value( page , index - 1 ) ;
+				err_if( ( * before ) == NULL , hoof_rc_error_file_bad ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_journal_replay( struct hoof * hoof , struct hoof_reader * reader , b * op , n * done )
+			{
+			/*!	\brief Reads one edit from the journal and makes it.
+				\param[in] hoof struct hoof context.
+				\param[in] reader The journal.
+				\param[in] op First word of the edit.
+				\param[out] done Set if the journal ends before the edit does, nothing is changed then.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			n * path = NULL ;
+			n depth = 0 ;
+			n * to_path = NULL ;
+			n to_depth = 0 ;
+			n position = 0 ;
+			b word[ hoof_max_word_length + 1 ] ;
+			struct hoof_value * parent = NULL ;
+			struct hoof_value * value = NULL ;
+			struct hoof_value * before = NULL ;
+			struct hoof_value * moving = NULL ;
+			struct hoof_interface interface ;
+			// code
+			// read the whole edit before changing anything
+			err_passthrough( hoof_journal_read_path( reader , & path , & depth , done ) ) ;
+			if ( * done )
+				{
+				goto cleanup ;
+				}
+			if ( hoof_words_are_same( op , ( b * ) "word" ) || hoof_words_are_same( op , ( b * ) "unword" ) || hoof_words_are_same( op , ( b * ) "sort" ) )
+				{
+				err_passthrough( hoof_journal_read_number( reader , & position , done ) ) ;
+				if ( * done )
+					{
+					goto cleanup ;
+					}
+				}
+			if ( hoof_words_are_same( op , ( b * ) "word" ) )
+				{
+				err_passthrough( hoof_journal_read_word( reader , word , done ) ) ;
+				if ( * done )
+					{
+					goto cleanup ;
+					}
+				}
+			if ( hoof_words_are_same( op , ( b * ) "move" ) )
+				{
+				err_passthrough( hoof_journal_read_path( reader , & to_path , & to_depth , done ) ) ;
+				if ( * done )
+					{
+					goto cleanup ;
+					}
+				}
+			// make the edit
+			err_passthrough( hoof_journal_find( hoof , path , depth , & parent , & value ) ) ;
+			if ( hoof_words_are_same( op , ( b * ) "value" ) )
+				{
+				err_passthrough( hoof_journal_place( hoof , parent , path[ depth - 1 ] , 1 , & before ) ) ;
+				if ( before != NULL )
+					{
+					err_passthrough( hoof_value_insert( hoof , before ) ) ;
+					}
+				goto cleanup ;
+				}
+			err_if( value == NULL , hoof_rc_error_file_bad ) ;
+			if ( hoof_words_are_same( op , ( b * ) "clear" ) )
+				{
+				hoof_value_clear( hoof , value ) ;
+				}
+			else if ( hoof_words_are_same( op , ( b * ) "unvalue" ) )
+				{
+				hoof_make_current_value( hoof , value ) ;
+				interface . output_value[ 0 ][ 0 ] = '\0' ;
+				hoof_value_delete( hoof , & interface ) ;
+				}
+			else if ( hoof_words_are_same( op , ( b * ) "sort" ) )
+				{
+				// for sort the number is how it sorted
+				err_if( position < 0 || position > ( hoof_sort_reverse | hoof_sort_all ) , hoof_rc_error_file_bad ) ;
+				err_passthrough( hoof_sort( hoof , value , position ) ) ;
+				}
+			else if ( hoof_words_are_same( op , ( b * ) "word" ) || hoof_words_are_same( op , ( b * ) "unword" ) )
+				{
+				// the journal counts words from 1, and a word can go right after the last one
+				err_if( position < 1 || position > value -> word_count + 1 , hoof_rc_error_file_bad ) ;
+				if ( hoof_words_are_same( op , ( b * ) "word" ) )
+					{
+					// the new word goes in front of whatever is at its position now
+					hoof_make_current_value( hoof , value ) ;
+					hoof -> current_word = position - 1 ;
+					err_passthrough( hoof_word_insert( hoof , word ) ) ;
+					}
+				else
+					{
+					err_if( position > value -> word_count , hoof_rc_error_file_bad ) ;
+					hoof_word_delete( hoof , value , position - 1 ) ;
+					}
+				}
+			else
+				{
+				err_if( ! hoof_words_are_same( op , ( b * ) "move" ) , hoof_rc_error_file_bad ) ;
+				// the root page can't be left empty
+				err_if( value -> out == NULL && value -> up -> sentinel && value -> down -> sentinel , hoof_rc_error_file_bad ) ;
+				// take the value out of its page, and drop the page if that empties it like move out does
+				hoof_value_unlink( hoof , value ) ;
+				moving = value ;
+				if ( value -> out != NULL && value -> out -> in -> down -> sentinel )
+					{
+					hoof_page_free( hoof , & ( value -> out -> in ) ) ;
+					}
+				// the destination path is where it is once the value has been taken out
+				err_passthrough( hoof_journal_find( hoof , to_path , to_depth , & parent , & value ) ) ;
+				err_passthrough( hoof_journal_place( hoof , parent , to_path[ to_depth - 1 ] , 0 , & before ) ) ;
+				hoof_value_link( hoof , moving , before ) ;
+				moving = NULL ;
+				}
+			// cleanup
+			cleanup:
+			// a value that was taken out but couldn't be put back is freed, the load fails anyway
+			if ( moving != NULL )
+				{
+				hoof_page_delete( hoof , & ( moving -> in ) ) ;
+				hoof_value_clear( hoof , moving ) ;
+				hoof_value_free( hoof , moving ) ;
+				}
+			hoof_memory_free( path ) ;
+			hoof_memory_free( to_path ) ;
+			return rc ;
+			}
+	// nodes
+		static void hoof_slab_init( struct hoof_slab * slab , n size )
+			{
+			// code
+			// a node given back holds the next free node, so it has to fit a pointer, and nodes after it have to stay aligned
+			if ( size < ( n ) sizeof( union hoof_slab_block ) )
+				{
+				size = sizeof( union hoof_slab_block ) ;
+				}
+			slab -> size = ( ( size + sizeof( union hoof_slab_block ) - 1 ) / sizeof( union hoof_slab_block ) ) * sizeof( union hoof_slab_block ) ;
+			slab -> free = NULL ;
+			slab -> blocks = NULL ;
+			slab -> left = 0 ;
+			}
+		static void * hoof_slab_take( struct hoof * hoof , struct hoof_slab * slab )
+			{
+			/*!	\brief Hands out a zeroed node.
+				\param[in] hoof struct hoof context.
+				\param[in] slab Slab for the kind of node.
+				\return The node, or null if we're out of memory.
+
+				Without hoof_option_slab every node is its own calloc.
+				*/
+			// data
+			union hoof_slab_block * block = NULL ;
+			b * node = NULL ;
+			n i = 0 ;
+			// code
+			if ( ! ( hoof -> options & hoof_option_slab ) )
+				{
+				return hoof_hook_calloc( 1 , slab -> size ) ;
+				}
+			if ( slab -> free != NULL )
+				{
+				node = ( b * ) slab -> free ;
+				slab -> free = slab -> free -> next ;
+				}
+			else
+				{
+				if ( slab -> left == 0 )
+					{
+					block = ( union hoof_slab_block * ) hoof_hook_malloc( sizeof( union hoof_slab_block ) + slab -> size * hoof_slab_block_nodes ) ;
+					if ( block == NULL )
+						{
+						return NULL ;
+						}
+					block -> next = slab -> blocks ;
+					slab -> blocks = block ;
+					slab -> left = hoof_slab_block_nodes ;
+					}
+				// nodes are handed out from the end of the newest block
+				slab -> left -= 1 ;
+				node = ( b * ) ( slab -> blocks + 1 ) + slab -> left * slab -> size ;
+				}
+			for ( i = 0 ; i < slab -> size ; i += 1 )
+				{
+				node[ i ] = 0 ;
+				}
+			return node ;
+			}
+		static void hoof_slab_give( struct hoof * hoof , struct hoof_slab * slab , void * node )
+			{
+			// data
+			struct hoof_slab_free * free_node = NULL ;
+			// code
+			if ( ! ( hoof -> options & hoof_option_slab ) )
+				{
+				hoof_hook_free( node ) ;
+				return ;
+				}
+			if ( node == NULL )
+				{
+				return ;
+				}
+			free_node = ( struct hoof_slab_free * ) node ;
+			free_node -> next = slab -> free ;
+			slab -> free = free_node ;
+			}
+		static void hoof_slab_release( struct hoof_slab * slab )
+			{
+			/*!	\brief Frees every block of a slab at once, along with all the nodes still in them.
+				\param[in] slab The slab.
+				\return void
+				*/
+			// data
+			union hoof_slab_block * block = NULL ;
+			// code
+			while ( slab -> blocks != NULL )
+				{
+				block = slab -> blocks ;
+				slab -> blocks = block -> next ;
+				hoof_memory_free( block ) ;
+				}
+			slab -> free = NULL ;
+			slab -> left = 0 ;
+			}
+		static struct hoof_intern * hoof_intern_find( struct hoof * hoof , b * text )
+			{
+			/*!	\brief Finds the intern for some text.
+				\param[in] hoof struct hoof context.
+				\param[in] text The text.
+				\return The intern, or null if no word has this text.
+				*/
+			// data
+			struct hoof_intern * intern = NULL ;
+			n hash = 0 ;
+			// code
+			if ( hoof -> interns == NULL )
+				{
+				return NULL ;
+				}
+			hash = hoof_word_hash( text ) ;
+			intern = hoof -> interns[ hash & ( hoof -> intern_slot_count - 1 ) ] ;
+			while ( intern != NULL && ( intern -> hash != hash || ! hoof_words_are_same( intern -> text , text ) ) )
+				{
+				intern = intern -> next ;
+				}
+			return intern ;
+			}
+		static n hoof_intern_grow( struct hoof * hoof )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_intern * * new_interns = NULL ;
+			n new_slot_count = 0 ;
+			struct hoof_intern * intern = NULL ;
+			struct hoof_intern * next = NULL ;
+			n i = 0 ;
+			// code
+			new_slot_count = hoof -> intern_slot_count * 2 ;
+			if ( new_slot_count == 0 )
+				{
+				new_slot_count = hoof_intern_slots_initial ;
+				}
+			hoof_memory_calloc( new_interns , struct hoof_intern * , new_slot_count ) ;
+			// the slot count is a power of 2, so the low bits of the hash pick the slot
+			for ( i = 0 ; i < hoof -> intern_slot_count ; i += 1 )
+				{
+				intern = hoof -> interns[ i ] ;
+				while ( intern != NULL )
+					{
+					next = intern -> next ;
+					intern -> next = new_interns[ intern -> hash & ( new_slot_count - 1 ) ] ;
+					new_interns[ intern -> hash & ( new_slot_count - 1 ) ] = intern ;
+					intern = next ;
+					}
+				}
+			hoof_memory_free( hoof -> interns ) ;
+			hoof -> interns = new_interns ;
+			new_interns = NULL ;
+			hoof -> intern_slot_count = new_slot_count ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( new_interns ) ;
+			return rc ;
+			}
+		static n hoof_intern_add( struct hoof * hoof , b * text , struct hoof_intern * * intern )
+			{
+			/*!	\brief Gets the intern for some text, adding it if no word has the text yet.
+				\param[in] hoof struct hoof context.
+				\param[in] text The text.
+				\param[out] intern On success, the intern, which counts one more word using it.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_intern * new_intern = NULL ;
+			n slot = 0 ;
+			n i = 0 ;
+			// code
+			( * intern ) = hoof_intern_find( hoof , text ) ;
+			if ( ( * intern ) != NULL )
+				{
+				( * intern ) -> count += 1 ;
+				goto cleanup ;
+				}
+			if ( hoof -> intern_count >= hoof -> intern_slot_count )
+				{
+				err_passthrough( hoof_intern_grow( hoof ) ) ;
+				}
+			hoof_node_calloc( hoof , intern_slab , new_intern , struct hoof_intern ) ;
+			// the node was zeroed, so the text is already terminated
+			while ( text[ i ] != '\0' && i < hoof_max_word_length )
+				{
+				new_intern -> text[ i ] = text[ i ] ;
+				i += 1 ;
+				}
+			new_intern -> length = ( b ) i ;
+			new_intern -> hash = hoof_word_hash( text ) ;
+			new_intern -> count = 1 ;
+			new_intern -> keyword =
+				   hoof_words_are_same( text , ( b * ) "done" )
+				|| hoof_words_are_same( text , ( b * ) "pause" )
+				|| hoof_words_are_same( text , ( b * ) "literal" ) ;
+			slot = new_intern -> hash & ( hoof -> intern_slot_count - 1 ) ;
+			new_intern -> next = hoof -> interns[ slot ] ;
+			hoof -> interns[ slot ] = new_intern ;
+			hoof -> intern_count += 1 ;
+			( * intern ) = new_intern ;
+			new_intern = NULL ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_intern_release( struct hoof * hoof , struct hoof_intern * intern )
+			{
+			/*!	\brief One less word uses an intern, and it's freed once no word does.
+				\param[in] hoof struct hoof context.
+				\param[in] intern The intern.
+				\return void
+				*/
+			// data
+			struct hoof_intern * * link = NULL ;
+			// code
+			intern -> count -= 1 ;
+			if ( intern -> count > 0 )
+				{
+				return ;
+				}
+			link = & hoof -> interns[ intern -> hash & ( hoof -> intern_slot_count - 1 ) ] ;
+			while ( ( * link ) != intern )
+				{
+				link = & ( * link ) -> next ;
+				}
+			( * link ) = intern -> next ;
+			hoof -> intern_count -= 1 ;
+			hoof_node_free( hoof , intern_slab , intern ) ;
+			}
+		static n hoof_words_size( n capacity )
+			{
+			// data
+			n size = 0 ;
+			n size_capacity = hoof_word_size_smallest ;
+			// code
+			// which slab a words array of this capacity comes from
+			while ( size_capacity < capacity )
+				{
+				size += 1 ;
+				size_capacity *= 2 ;
+				}
+			return size ;
+			}
+		static n hoof_words_reserve( struct hoof * hoof , struct hoof_value * value , n count )
+			{
+			/*!	\brief Makes sure value has room for count words.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value.
+				\param[in] count How many words it needs room for.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_intern * * new_words = NULL ;
+			n new_capacity = 0 ;
+			n size = 0 ;
+			n i = 0 ;
+			// code
+			if ( count <= value -> word_capacity )
+				{
+				goto cleanup ;
+				}
+			paranoid_err_if( count > hoof_word_size_smallest << ( hoof_word_sizes - 1 ) ) ;
+			size = hoof_words_size( count ) ;
+			new_capacity = hoof_word_size_smallest << size ;
+			hoof_node_calloc( hoof , word_slabs[ size ] , new_words , struct hoof_intern * ) ;
+			for ( i = 0 ; i < value -> word_count ; i += 1 )
+				{
+				new_words[ i ] = value -> words[ i ] ;
+				}
+			hoof_words_free( hoof , value ) ;
+			value -> words = new_words ;
+			new_words = NULL ;
+			value -> word_capacity = ( b ) new_capacity ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_words_free( struct hoof * hoof , struct hoof_value * value )
+			{
+			/*!	\brief Frees value's words array, its interns have to have been given back already.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value.
+				\return void
+				*/
+			// code
+			if ( value -> words != NULL )
+				{
+				hoof_node_free( hoof , word_slabs[ hoof_words_size( value -> word_capacity ) ] , value -> words ) ;
+				}
+			value -> word_capacity = 0 ;
+			}
+		static void hoof_value_free( struct hoof * hoof , struct hoof_value * value )
+			{
+			/*!	\brief Frees a value whose words have already been cleared.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value, which has to be out of its page already.
+				\return void
+				*/
+			// code
+			hoof_words_free( hoof , value ) ;
+			hoof_node_free( hoof , value_slab , value ) ;
+			}
+		static void hoof_page_free( struct hoof * hoof , struct hoof_value * * page_F )
+			{
+			/*!	\brief Frees a page that has no values left in it, only its value head and tail.
+				\param[in] hoof struct hoof context.
+				\param[in] page_F Value head of the page, set to null.
+				\return void
+				*/
+			// code
+			hoof_dig_index_free( hoof , ( * page_F ) ) ;
+			hoof_node_free( hoof , page_slab , ( * page_F ) -> page ) ;
+			hoof_node_free( hoof , value_slab , ( * page_F ) -> down ) ; // value tail
+			hoof_node_free( hoof , value_slab , ( * page_F ) ) ;
+			}
+	// index
+		static n hoof_index_size( struct hoof_value * node )
+			{
+			// code
+			if ( node == NULL )
+				{
+				return 0 ;
+				}
+			return node -> index_size ;
+			}
+		static struct hoof_value * hoof_index_first( struct hoof_value * node )
+			{
+			// code
+			while ( node -> index_left != NULL )
+				{
+				node = node -> index_left ;
+				}
+			return node ;
+			}
+		static void hoof_index_rotate( struct hoof_value * node )
+			{
+			/*!	\brief Moves node above its parent in the treap, keeping the page order.
+				\param[in] node The node, its parent can't be the page head.
+				\return void
+				*/
+			// data
+			struct hoof_value * parent = NULL ;
+			struct hoof_value * grandparent = NULL ;
+			// code
+			parent = node -> index_parent ;
+			grandparent = parent -> index_parent ;
+			if ( parent -> index_left == node )
+				{
+				parent -> index_left = node -> index_right ;
+				if ( node -> index_right != NULL )
+					{
+					node -> index_right -> index_parent = parent ;
+					}
+				node -> index_right = parent ;
+				}
+			else
+				{
+				parent -> index_right = node -> index_left ;
+				if ( node -> index_left != NULL )
+					{
+					node -> index_left -> index_parent = parent ;
+					}
+				node -> index_left = parent ;
+				}
+			parent -> index_parent = node ;
+			node -> index_parent = grandparent ;
+			// the page head keeps the root in index_left, so this works for it too
+			if ( grandparent -> index_left == parent )
+				{
+				grandparent -> index_left = node ;
+				}
+			else
+				{
+				grandparent -> index_right = node ;
+				}
+			node -> index_size = parent -> index_size ;
+			parent -> index_size = 1 + hoof_index_size( parent -> index_left ) + hoof_index_size( parent -> index_right ) ;
+			}
+		static void hoof_index_add( struct hoof * hoof , struct hoof_value * value )
+			{
+			/*!	\brief Adds a value to its page's treap, right after the value above it.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value, already linked in to its page.
+				\return void
+				*/
+			// data
+			struct hoof_value * parent = NULL ;
+			struct hoof_value * node = NULL ;
+			// code
+			value -> index_left = NULL ;
+			value -> index_right = NULL ;
+			value -> index_size = 1 ;
+			hoof -> index_seed = ( hoof -> index_seed * 1103515245 + 12345 ) & 0x7fffffff ;
+			value -> index_priority = hoof -> index_seed ;
+			// the spot right after up is the first one in up's right subtree, or up's right if it's empty
+			parent = value -> up ;
+			if ( parent -> sentinel )
+				{
+				if ( parent -> index_left != NULL )
+					{
+					parent = hoof_index_first( parent -> index_left ) ;
+					}
+				parent -> index_left = value ;
+				}
+			else if ( parent -> index_right == NULL )
+				{
+				parent -> index_right = value ;
+				}
+			else
+				{
+				parent = hoof_index_first( parent -> index_right ) ;
+				parent -> index_left = value ;
+				}
+			value -> index_parent = parent ;
+			for ( node = parent ; ! node -> sentinel ; node = node -> index_parent )
+				{
+				node -> index_size += 1 ;
+				}
+			while ( ! value -> index_parent -> sentinel && value -> index_parent -> index_priority < value -> index_priority )
+				{
+				hoof_index_rotate( value ) ;
+				}
+			}
+		static void hoof_index_remove( struct hoof_value * value )
+			{
+			/*!	\brief Takes a value out of its page's treap.
+				\param[in] value The value.
+				\return void
+				*/
+			// data
+			struct hoof_value * child = NULL ;
+			struct hoof_value * node = NULL ;
+			// code
+			// rotate it down until it's a leaf
+			while ( value -> index_left != NULL || value -> index_right != NULL )
+				{
+				child = value -> index_left ;
+				if ( child == NULL || ( value -> index_right != NULL && value -> index_right -> index_priority > child -> index_priority ) )
+					{
+					child = value -> index_right ;
+					}
+				hoof_index_rotate( child ) ;
+				}
+			node = value -> index_parent ;
+			if ( node -> index_left == value )
+				{
+				node -> index_left = NULL ;
+				}
+			else
+				{
+				node -> index_right = NULL ;
+				}
+			for ( ; ! node -> sentinel ; node = node -> index_parent )
+				{
+				node -> index_size -= 1 ;
+				}
+			value -> index_parent = NULL ;
+			}
+		static n hoof_index_of( struct hoof_value * value )
+			{
+			/*!	\brief Finds where a value is in its page.
+				\param[in] value The value.
+				\return how many values are above it
+				*/
+			// data
+			n index = 0 ;
+			// code
+			index = hoof_index_size( value -> index_left ) ;
+			while ( ! value -> index_parent -> sentinel )
+				{
+				if ( value -> index_parent -> index_right == value )
+					{
+					index += hoof_index_size( value -> index_parent -> index_left ) + 1 ;
+					}
+				value = value -> index_parent ;
+				}
+			return index ;
+			}
+		static struct hoof_value * hoof_index_page( struct hoof_value * value )
+			{
+			// code
+			// the root of the treap hangs off the page head
+			while ( ! value -> sentinel )
+				{
+				value = value -> index_parent ;
+				}
+			return value ;
+			}
+		static n hoof_index_count( struct hoof_value * page )
+			{
+			// code
+			return hoof_index_size( page -> index_left ) ;
+			}
+		static struct hoof_value * hoof_index_value( struct hoof_value * page , n index )
+			{
+			/*!	\brief Finds the value at a position in a page.
+				\param[in] page Value head of the page.
+				\param[in] index How many values are above it.
+				\return the value, null if the page doesn't have that many
+				*/
+			// data
+			struct hoof_value * node = NULL ;
+			n left = 0 ;
+			// code
+			node = page -> index_left ;
+			while ( node != NULL )
+				{
+				left = hoof_index_size( node -> index_left ) ;
+				if ( index < left )
+					{
+					node = node -> index_left ;
+					}
+				else if ( index == left )
+					{
+					break ;
+					}
+				else
+					{
+					index -= left + 1 ;
+					node = node -> index_right ;
+					}
+				}
+			return node ;
+			}
+		static void hoof_value_link( struct hoof * hoof , struct hoof_value * value , struct hoof_value * before )
+			{
+			/*!	\brief Puts a value in a page.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value, which isn't in a page.
+				\param[in] before Value or page head it goes after.
+				\return void
+				*/
+			// code
+			value -> up = before ;
+			value -> down = before -> down ;
+			before -> down -> up = value ;
+			before -> down = value ;
+			value -> out = before -> out ;
+			hoof_index_add( hoof , value ) ;
+			hoof_page_dirty( hoof , value -> out ) ;
+			}
+		static void hoof_value_unlink( struct hoof * hoof , struct hoof_value * value )
+			{
+			/*!	\brief Takes a value out of its page, the page is left alone even if it's empty now.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value.
+				\return void
+				*/
+			// code
+			hoof_index_remove( value ) ;
+			value -> up -> down = value -> down ;
+			value -> down -> up = value -> up ;
+			hoof_page_dirty( hoof , value -> out ) ;
+			}
+	// dig index
+		static n hoof_dig_index_child( struct hoof_dig_index * index , n parent , struct hoof_intern * word )
+			{
+			/*!	\brief Finds the node for parent's words followed by word.
+				\param[in] index The dig index.
+				\param[in] parent Node for the words before word.
+				\param[in] word The word, can be null.
+				\return the node, -1 if no value starts with those words
+				*/
+			// data
+			n node = -1 ;
+			// code
+			if ( word == NULL )
+				{
+				return -1 ;
+				}
+			node = index -> slots[ ( word -> hash * 31 + parent ) & ( index -> slot_count - 1 ) ] ;
+			while ( node != -1 && ( index -> nodes[ node ] . parent != parent || index -> nodes[ node ] . word != word ) )
+				{
+				node = index -> nodes[ node ] . next ;
+				}
+			return node ;
+			}
+		static n hoof_dig_index_add( struct hoof_dig_index * index , n parent , struct hoof_intern * word )
+			{
+			// data
+			n node = 0 ;
+			n slot = 0 ;
+			// code
+			node = hoof_dig_index_child( index , parent , word ) ;
+			if ( node != -1 )
+				{
+				return node ;
+				}
+			// the nodes array was made big enough for every word in the page
+			node = index -> node_count ;
+			index -> node_count += 1 ;
+			slot = ( word -> hash * 31 + parent ) & ( index -> slot_count - 1 ) ;
+			index -> nodes[ node ] . word = word ;
+			index -> nodes[ node ] . parent = parent ;
+			index -> nodes[ node ] . next = index -> slots[ slot ] ;
+			index -> slots[ slot ] = node ;
+			return node ;
+			}
+		static n hoof_dig_index_build( struct hoof * hoof , struct hoof_value * page )
+			{
+			/*!	\brief Builds the dig index of a page.
+				\param[in] hoof struct hoof context.
+				\param[in] page Value head of the page.
+				\return n
+
+				Every value adds its position to the node of each of its prefixes, so a
+				node lists in page order every value that starts with its words.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_dig_index * new_index = NULL ;
+			struct hoof_value * value = NULL ;
+			n value_count = 0 ;
+			n word_count = 0 ;
+			n total = 0 ;
+			n position = 0 ;
+			n node = 0 ;
+			n pass = 0 ;
+			n i = 0 ;
+			// code
+			value_count = hoof_index_count( page ) ;
+			for ( value = page -> down ; ! value -> sentinel ; value = value -> down )
+				{
+				word_count += value -> word_count ;
+				}
+			hoof_memory_calloc( new_index , struct hoof_dig_index , 1 ) ;
+			hoof_memory_malloc( new_index -> values , struct hoof_value * , value_count ) ;
+			hoof_memory_calloc( new_index -> nodes , struct hoof_dig_node , word_count + 1 ) ;
+			new_index -> slot_count = 1 ;
+			while ( new_index -> slot_count < ( word_count + 1 ) * 2 )
+				{
+				new_index -> slot_count *= 2 ;
+				}
+			hoof_memory_malloc( new_index -> slots , n , new_index -> slot_count ) ;
+			for ( i = 0 ; i < new_index -> slot_count ; i += 1 )
+				{
+				new_index -> slots[ i ] = -1 ;
+				}
+			new_index -> nodes[ 0 ] . parent = -1 ;
+			new_index -> nodes[ 0 ] . next = -1 ;
+			new_index -> node_count = 1 ;
+			// the first pass counts how many values each node has, the second fills in their positions
+			for ( pass = 0 ; pass < 2 ; pass += 1 )
+				{
+				position = 0 ;
+				for ( value = page -> down ; ! value -> sentinel ; value = value -> down )
+					{
+					new_index -> values[ position ] = value ;
+					node = 0 ;
+					for ( i = 0 ; i <= value -> word_count ; i += 1 )
+						{
+						if ( i > 0 )
+							{
+							node = hoof_dig_index_add( new_index , node , value -> words[ i - 1 ] ) ;
+							}
+						if ( pass == 1 )
+							{
+							new_index -> positions[ new_index -> nodes[ node ] . first + new_index -> nodes[ node ] . count ] = position ;
+							}
+						new_index -> nodes[ node ] . count += 1 ;
+						}
+					if ( pass == 1 )
+						{
+						new_index -> positions[ new_index -> nodes[ node ] . exact + new_index -> nodes[ node ] . exact_count ] = position ;
+						}
+					new_index -> nodes[ node ] . exact_count += 1 ;
+					position += 1 ;
+					}
+				if ( pass == 0 )
+					{
+					for ( node = 0 ; node < new_index -> node_count ; node += 1 )
+						{
+						new_index -> nodes[ node ] . first = total ;
+						total += new_index -> nodes[ node ] . count ;
+						new_index -> nodes[ node ] . exact = total ;
+						total += new_index -> nodes[ node ] . exact_count ;
+						new_index -> nodes[ node ] . count = 0 ;
+						new_index -> nodes[ node ] . exact_count = 0 ;
+						}
+					hoof_memory_malloc( new_index -> positions , n , total ) ;
+					}
+				}
+			new_index -> page = page ;
+			new_index -> next = hoof -> dig_indexes ;
+			if ( hoof -> dig_indexes != NULL )
+				{
+				hoof -> dig_indexes -> previous = new_index ;
+				}
+			hoof -> dig_indexes = new_index ;
+			page -> page -> dig_index = new_index ;
+			new_index = NULL ;
+			// cleanup
+			cleanup:
+			if ( new_index != NULL )
+				{
+				hoof_memory_free( new_index -> values ) ;
+				hoof_memory_free( new_index -> nodes ) ;
+				hoof_memory_free( new_index -> slots ) ;
+				hoof_memory_free( new_index -> positions ) ;
+				hoof_memory_free( new_index ) ;
+				}
+			return rc ;
+			}
+		static void hoof_dig_index_free( struct hoof * hoof , struct hoof_value * page )
+			{
+			/*!	\brief Frees the dig index of a page, if it has one.
+				\param[in] hoof struct hoof context.
+				\param[in] page Value head of the page.
+				\return void
+				*/
+			// data
+			struct hoof_dig_index * index = NULL ;
+			// code
+			index = page -> page -> dig_index ;
+			if ( index == NULL )
+				{
+				return ;
+				}
+			if ( index -> previous != NULL )
+				{
+				index -> previous -> next = index -> next ;
+				}
+			else
+				{
+				hoof -> dig_indexes = index -> next ;
+				}
+			if ( index -> next != NULL )
+				{
+				index -> next -> previous = index -> previous ;
+				}
+			hoof_memory_free( index -> values ) ;
+			hoof_memory_free( index -> nodes ) ;
+			hoof_memory_free( index -> slots ) ;
+			hoof_memory_free( index -> positions ) ;
+			hoof_memory_free( index ) ;
+			page -> page -> dig_index = NULL ;
+			}
+		static n hoof_dig_index_search( struct hoof * hoof , struct hoof_intern * intern , n exact )
+			{
+			/*!	\brief Finds the next value that matches the dig with the page's dig index.
+				\param[in] hoof struct hoof context.
+				\param[in] intern Next word of the dig, null if it isn't in the tree.
+				\param[in] exact Find a value that's exactly the words so far instead, intern isn't used.
+				\return 1 if the page has a dig index and current_value was updated like hoof_dig does, 0 if hoof_dig has to scan
+				*/
+			// data
+			struct hoof_value * page = NULL ;
+			struct hoof_dig_index * index = NULL ;
+			n next = 0 ;
+			n node = 0 ;
+			n first = 0 ;
+			n count = 0 ;
+			n start = 0 ;
+			n low = 0 ;
+			n high = 0 ;
+			n middle = 0 ;
+			n i = 0 ;
+			// code
+			if ( ! ( hoof -> options & hoof_option_dig_index ) )
+				{
+				return 0 ;
+				}
+			page = hoof_index_page( hoof -> current_value ) ;
+			if ( hoof_index_count( page ) < hoof_dig_index_min )
+				{
+				return 0 ;
+				}
+			// if there isn't memory for the index we can still scan
+			if ( page -> page -> dig_index == NULL && hoof_dig_index_build( hoof , page ) != hoof_rc_success )
+				{
+				return 0 ;
+				}
+			index = page -> page -> dig_index ;
+			// current_value is in the index, so the words it has matched so far are too
+			next = hoof -> current_word + 1 ;
+			for ( i = 0 ; i < next ; i += 1 )
+				{
+				node = hoof_dig_index_child( index , node , hoof -> current_value -> words[ i ] ) ;
+				}
+			if ( ! exact )
+				{
+				node = hoof_dig_index_child( index , node , intern ) ;
+				}
+			// the first value at or after current_value, positions are in page order
+			low = 0 ;
+			high = 0 ;
+			if ( node != -1 )
+				{
+				first = exact ? index -> nodes[ node ] . exact : index -> nodes[ node ] . first ;
+				count = exact ? index -> nodes[ node ] . exact_count : index -> nodes[ node ] . count ;
+				start = hoof_index_of( hoof -> current_value ) ;
+				low = first ;
+				high = first + count ;
+				while ( low < high )
+					{
+					middle = low + ( high - low ) / 2 ;
+					if ( index -> positions[ middle ] < start )
+						{
+						low = middle + 1 ;
+						}
+					else
+						{
+						high = middle ;
+						}
+					}
+				high = first + count ;
+				}
+			if ( low < high )
+				{
+				hoof -> current_value = index -> values[ index -> positions[ low ] ] ;
+				hoof -> current_word = next ;
+				}
+			else
+				{
+				// no match, so we end up at the tail like a scan would
+				hoof -> current_value = hoof_index_value( page , hoof_index_count( page ) - 1 ) -> down ;
+				}
+			return 1 ;
+			}
+	// dig candidates
+		static n hoof_dig_candidates_start( struct hoof * hoof )
+			{
+			/*!	\brief Makes every value from current_value down a candidate for the dig.
+				\param[in] hoof struct hoof context.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * page = NULL ;
+			struct hoof_value * value = NULL ;
+			n count = 0 ;
+			// code
+			page = hoof_index_page( hoof -> current_value ) ;
+			count = hoof_index_count( page ) - hoof_index_of( hoof -> current_value ) ;
+			if ( count > hoof -> dig_candidate_capacity )
+				{
+				hoof_memory_free( hoof -> dig_candidates ) ;
+				hoof -> dig_candidate_capacity = 0 ;
+				hoof_memory_malloc( hoof -> dig_candidates , struct hoof_value * , count ) ;
+				hoof -> dig_candidate_capacity = count ;
+				}
+			count = 0 ;
+			for ( value = hoof -> current_value ; ! value -> sentinel ; value = value -> down )
+				{
+				hoof -> dig_candidates[ count ] = value ;
+				count += 1 ;
+				}
+			hoof -> dig_candidate_count = count ;
+			hoof -> dig_candidate_words = 0 ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_dig_candidates_narrow( struct hoof * hoof , struct hoof_intern * intern , n exact )
+			{
+			/*!	\brief Finds the next value that matches the dig by dropping the candidates that don't.
+				\param[in] hoof struct hoof context.
+				\param[in] intern Next word of the dig, null if it isn't in the tree.
+				\param[in] exact Find a value that's exactly the words so far instead, intern isn't used.
+				\return 1 if current_value was updated like hoof_dig does, 0 if there isn't memory for the candidates and hoof_dig has to scan
+
+				Each word only looks at the values that matched the words before it. Words
+				that current_value matched without narrowing are checked here too.
+				*/
+			// data
+			struct hoof_value * value = NULL ;
+			n next = 0 ;
+			n kept = 0 ;
+			n match = 0 ;
+			n i = 0 ;
+			n j = 0 ;
+			// code
+			if ( hoof -> dig_candidate_words == -1 && hoof_dig_candidates_start( hoof ) != hoof_rc_success )
+				{
+				return 0 ;
+				}
+			next = hoof -> current_word + 1 ;
+			for ( i = 0 ; i < hoof -> dig_candidate_count ; i += 1 )
+				{
+				value = hoof -> dig_candidates[ i ] ;
+				if ( exact )
+					{
+					match = value -> word_count == next ;
+					}
+				else
+					{
+					match = value -> word_count > next && value -> words[ next ] == intern ;
+					}
+				for ( j = hoof -> dig_candidate_words ; match && j < next ; j += 1 )
+					{
+					match = value -> words[ j ] == hoof -> current_value -> words[ j ] ;
+					}
+				if ( match )
+					{
+					hoof -> dig_candidates[ kept ] = value ;
+					kept += 1 ;
+					}
+				}
+			if ( kept > 0 )
+				{
+				hoof -> current_value = hoof -> dig_candidates[ 0 ] ;
+				hoof -> current_word = next ;
+				}
+			else
+				{
+				// no match, so we end up at the tail like a scan would
+				value = hoof_index_page( hoof -> current_value ) ;
+				hoof -> current_value = hoof_index_value( value , hoof_index_count( value ) - 1 ) -> down ;
+				}
+			hoof -> dig_candidate_count = kept ;
+			hoof -> dig_candidate_words = next + 1 ;
+			// only values that are exactly the words are left, so the dig can't go on from them
+			if ( exact )
+				{
+				hoof -> dig_candidate_words = -1 ;
+				}
+			return 1 ;
+			}
+	// search
+		static n hoof_posting_add( struct hoof * hoof , struct hoof_value * value , struct hoof_intern * word )
+			{
+			/*!	\brief Notes in the search index that a value has one more of a word.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value.
+				\param[in] word Intern of the word.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_posting * posting = NULL ;
+			// code
+			if ( ! ( hoof -> options & hoof_option_search_index ) )
+				{
+				goto cleanup ;
+				}
+			// a value has at most hoof_max_value_length words, so its list is short
+			for ( posting = value -> postings ; posting != NULL ; posting = posting -> next_word )
+				{
+				if ( posting -> word == word )
+					{
+					posting -> count += 1 ;
+					goto cleanup ;
+					}
+				}
+			hoof_node_calloc( hoof , posting_slab , posting , struct hoof_posting ) ;
+			posting -> value = value ;
+			posting -> word = word ;
+			posting -> count = 1 ;
+			posting -> next_word = value -> postings ;
+			value -> postings = posting ;
+			posting -> next = word -> postings ;
+			if ( word -> postings != NULL )
+				{
+				word -> postings -> previous = posting ;
+				}
+			word -> postings = posting ;
+			word -> posting_count += 1 ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_posting_remove( struct hoof * hoof , struct hoof_value * value , struct hoof_intern * word )
+			{
+			/*!	\brief Notes in the search index that a value has one less of a word.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value.
+				\param[in] word Intern of the word, which the value has.
+				\return void
+				*/
+			// data
+			struct hoof_posting * * link = NULL ;
+			struct hoof_posting * posting = NULL ;
+			// code
+			if ( ! ( hoof -> options & hoof_option_search_index ) )
+				{
+				return ;
+				}
+			link = & value -> postings ;
+			while ( ( * link ) -> word != word )
+				{
+				link = & ( * link ) -> next_word ;
+				}
+			posting = ( * link ) ;
+			posting -> count -= 1 ;
+			if ( posting -> count > 0 )
+				{
+				return ;
+				}
+			( * link ) = posting -> next_word ;
+			if ( posting -> previous != NULL )
+				{
+				posting -> previous -> next = posting -> next ;
+				}
+			else
+				{
+				word -> postings = posting -> next ;
+				}
+			if ( posting -> next != NULL )
+				{
+				posting -> next -> previous = posting -> previous ;
+				}
+			word -> posting_count -= 1 ;
+			hoof_node_free( hoof , posting_slab , posting ) ;
+			}
+		static struct hoof_value * hoof_tree_next( struct hoof_value * value )
+			{
+			/*!	\brief Finds the value after a value in the whole hierarchy.
+				\param[in] value The value.
+				\return the next value, null if value was the last one
+
+				A value is followed by the values of its in page, then by the value below it.
+				Unloaded pages are skipped.
+				*/
+			// code
+			if ( value -> in != NULL && value -> in -> page -> unloaded == 0 )
+				{
+				value = value -> in -> down ;
+				}
+			else
+				{
+				value = value -> down ;
+				}
+			while ( value -> sentinel )
+				{
+				if ( value -> out == NULL )
+					{
+					return NULL ;
+					}
+				value = value -> out -> down ;
+				}
+			return value ;
+			}
+		static n hoof_tree_before( struct hoof_value * value_1 , struct hoof_value * value_2 )
+			{
+			/*!	\brief Tells if a value comes before another in the whole hierarchy, like hoof_tree_next goes.
+				\param[in] value_1 A value.
+				\param[in] value_2 Another value.
+				\return 1 if value_1 comes first, 0 if value_2 does or they are the same value
+				*/
+			// data
+			struct hoof_value * value = NULL ;
+			n depth_1 = 0 ;
+			n depth_2 = 0 ;
+			// code
+			for ( value = value_1 -> out ; value != NULL ; value = value -> out )
+				{
+				depth_1 += 1 ;
+				}
+			for ( value = value_2 -> out ; value != NULL ; value = value -> out )
+				{
+				depth_2 += 1 ;
+				}
+			// a value comes before every value inside it
+			while ( depth_1 > depth_2 )
+				{
+				value_1 = value_1 -> out ;
+				depth_1 -= 1 ;
+				if ( value_1 == value_2 )
+					{
+					return 0 ;
+					}
+				}
+			while ( depth_2 > depth_1 )
+				{
+				value_2 = value_2 -> out ;
+				depth_2 -= 1 ;
+				if ( value_2 == value_1 )
+					{
+					return 1 ;
+					}
+				}
+			// then the values they are inside of are in the same page
+			while ( value_1 -> out != value_2 -> out )
+				{
+				value_1 = value_1 -> out ;
+				value_2 = value_2 -> out ;
+				}
+			return hoof_index_of( value_1 ) < hoof_index_of( value_2 ) ;
+			}
+		static n hoof_values_sort( struct hoof_value * * values , n count , n ( * before )( struct hoof_value * value_1 , struct hoof_value * value_2 ) )
+			{
+			/*!	\brief Merge sorts values, values that neither comes before keep their order.
+				\param[in,out] values The values.
+				\param[in] count How many values.
+				\param[in] before Tells if one value goes before another.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * * scratch = NULL ;
+			n width = 0 ;
+			n start = 0 ;
+			n middle = 0 ;
+			n end = 0 ;
+			n i = 0 ;
+			n j = 0 ;
+			n k = 0 ;
+			// code
+			if ( count < 2 )
+				{
+				goto cleanup ;
+				}
+			hoof_memory_malloc( scratch , struct hoof_value * , count ) ;
+			// merge runs of width values in to runs twice as long
+			for ( width = 1 ; width < count ; width *= 2 )
+				{
+				for ( start = 0 ; start < count ; start += width * 2 )
+					{
+					middle = start + width < count ? start + width : count ;
+					end = start + width * 2 < count ? start + width * 2 : count ;
+					i = start ;
+					j = middle ;
+					k = start ;
+					while ( k < end )
+						{
+						// the right run only goes first if it's really before, so equal values stay in order
+						if ( j < end && ( i == middle || before( values[ j ] , values[ i ] ) ) )
+							{
+							scratch[ k ] = values[ j ] ;
+							j += 1 ;
+							}
+						else
+							{
+							scratch[ k ] = values[ i ] ;
+							i += 1 ;
+							}
+						k += 1 ;
+						}
+					}
+				for ( k = 0 ; k < count ; k += 1 )
+					{
+					values[ k ] = scratch[ k ] ;
+					}
+				}
+			// cleanup
+			cleanup:
+			hoof_memory_free( scratch ) ;
+			return rc ;
+			}
+		static void hoof_search_word( struct hoof * hoof , b * word , n * huh )
+			{
+			/*!	\brief Adds a word to what we're searching for.
+				\param[in] hoof struct hoof context.
+				\param[in] word The word.
+				\param[out] huh Set if there are already as many words as a value can have.
+				\return void
+				*/
+			// data
+			b * text = NULL ;
+			n i = 0 ;
+			// code
+			if ( hoof -> search_word_count == hoof_max_value_length )
+				{
+				( * huh ) = 1 ;
+				return ;
+				}
+			text = hoof -> search_words[ hoof -> search_word_count ] ;
+			while ( word[ i ] != '\0' )
+				{
+				text[ i ] = word[ i ] ;
+				i += 1 ;
+				}
+			text[ i ] = '\0' ;
+			hoof -> search_word_count += 1 ;
+			}
+		static n hoof_search_has( struct hoof_value * value , struct hoof_intern * * words , n count )
+			{
+			/*!	\brief Tells if a value has some words next to each other.
+				\param[in] value The value.
+				\param[in] words Interns of the words.
+				\param[in] count How many words.
+				\return 1 if it does, 0 if it doesn't
+				*/
+			// data
+			n i = 0 ;
+			n j = 0 ;
+			// code
+			for ( i = 0 ; i + count <= value -> word_count ; i += 1 )
+				{
+				j = 0 ;
+				while ( j < count && value -> words[ i + j ] == words[ j ] )
+					{
+					j += 1 ;
+					}
+				if ( j == count )
+					{
+					return 1 ;
+					}
+				}
+			return 0 ;
+			}
+		static n hoof_search_reserve( struct hoof * hoof , n count )
+			{
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * * new_results = NULL ;
+			n new_capacity = 0 ;
+			n i = 0 ;
+			// code
+			if ( count <= hoof -> search_result_capacity )
+				{
+				goto cleanup ;
+				}
+			new_capacity = hoof -> search_result_capacity * 2 ;
+			if ( new_capacity < count )
+				{
+				new_capacity = count ;
+				}
+			hoof_memory_malloc( new_results , struct hoof_value * , new_capacity ) ;
+			for ( i = 0 ; i < hoof -> search_result_count ; i += 1 )
+				{
+				new_results[ i ] = hoof -> search_results[ i ] ;
+				}
+			hoof_memory_free( hoof -> search_results ) ;
+			hoof -> search_results = new_results ;
+			new_results = NULL ;
+			hoof -> search_result_capacity = new_capacity ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( new_results ) ;
+			return rc ;
+			}
+		static n hoof_search_load( struct hoof * hoof )
+			{
+			/*!	\brief Loads every page that's still unloaded, so search sees the whole hierarchy.
+				\param[in] hoof struct hoof context.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * value = NULL ;
+			// code
+			if ( ! hoof -> some_unloaded )
+				{
+				goto cleanup ;
+				}
+			// a page is loaded before hoof_tree_next goes in to it
+			for ( value = hoof -> root -> down ; value != NULL ; value = hoof_tree_next( value ) )
+				{
+				err_passthrough( hoof_page_load( hoof , value ) ) ;
+				}
+			hoof -> some_unloaded = 0 ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static void hoof_search_chunk( struct hoof_search_worker * worker , struct hoof_search_chunk * chunk )
+			{
+			/*!	\brief Counts or collects the values in a chunk of the hierarchy that have the search words.
+				\param[in] worker What to search for, and whether to fill in the values.
+				\param[in,out] chunk The chunk.
+				\return void
+
+				Only reads the hierarchy and the chunk, and doesn't allocate, so chunks can be
+				scanned at the same time without the memory hooks hearing from more than one thread.
+				*/
+			// data
+			struct hoof_value * value = NULL ;
+			// code
+			chunk -> count = 0 ;
+			for ( value = chunk -> start ; value != chunk -> stop ; value = hoof_tree_next( value ) )
+				{
+				if ( ! hoof_search_has( value , worker -> words , worker -> word_count ) )
+					{
+					continue ;
+					}
+				if ( worker -> fill )
+					{
+					chunk -> values[ chunk -> count ] = value ;
+					}
+				chunk -> count += 1 ;
+				}
+			}
+		static void hoof_search_work( struct hoof_search_worker * worker )
+			{
+			// data
+			n i = 0 ;
+			// code
+			for ( i = worker -> first ; i < worker -> chunk_count ; i += worker -> step )
+				{
+				hoof_search_chunk( worker , & worker -> chunks[ i ] ) ;
+				}
+			}
+		#ifdef hoof_use_threads
+			static void * hoof_search_thread( void * worker )
+				{
+				// code
+				hoof_search_work( ( struct hoof_search_worker * ) worker ) ;
+				return NULL ;
+				}
+		#endif
+		static void hoof_search_run( struct hoof_search_worker * workers , n worker_count )
+			{
+			/*!	\brief Has every worker scan its chunks, each on its own thread if it can get one.
+				\param[in] workers The workers.
+				\param[in] worker_count How many workers.
+				\return void
+				*/
+			// data
+			#ifdef hoof_use_threads
+				pthread_t threads[ hoof_search_threads_max ] ;
+				n started[ hoof_search_threads_max ] ;
+				n i = 0 ;
+			#endif
+			// code
+			#ifdef hoof_use_threads
+				for ( i = 1 ; i < worker_count ; i += 1 )
+					{
+					started[ i ] = pthread_create( & threads[ i ] , NULL , hoof_search_thread , & workers[ i ] ) == 0 ;
+					}
+			#else
+				( void ) worker_count ;
+			#endif
+			hoof_search_work( & workers[ 0 ] ) ;
+			#ifdef hoof_use_threads
+				for ( i = 1 ; i < worker_count ; i += 1 )
+					{
+					if ( started[ i ] )
+						{
+						pthread_join( threads[ i ] , NULL ) ;
+						}
+					else
+						{
+						hoof_search_work( & workers[ i ] ) ;
+						}
+					}
+			#endif
+			}
+		static n hoof_search_scan( struct hoof * hoof , struct hoof_intern * * words )
+			{
+			/*!	\brief Finds the values that have the search words by scanning the whole hierarchy.
+				\param[in] hoof struct hoof context.
+				\param[in] words Interns of the search words.
+				\return n
+
+				With hoof_use_threads the root page is cut in to chunks of root values and
+				their pages, and a thread for each core scans its share of the chunks. The
+				chunks are scanned twice, first to count what each one finds so this thread can
+				make room for the results, then to put them in that room in chunk order, which is
+				the order hoof_tree_next goes. Without threads, or if a thread can't be started,
+				this thread scans the chunks instead.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_search_worker workers[ hoof_search_threads_max ] ;
+			struct hoof_search_chunk * chunks = NULL ;
+			n worker_count = 1 ;
+			n chunk_count = 1 ;
+			n root_count = 0 ;
+			n total = 0 ;
+			n i = 0 ;
+			// code
+			root_count = hoof_index_count( hoof -> root ) ;
+			#ifdef hoof_use_threads
+				#ifdef _SC_NPROCESSORS_ONLN
+					worker_count = ( n ) sysconf( _SC_NPROCESSORS_ONLN ) ;
+				#endif
+				if ( worker_count < 1 )
+					{
+					worker_count = 1 ;
+					}
+				if ( worker_count > hoof_search_threads_max )
+					{
+					worker_count = hoof_search_threads_max ;
+					}
+				// more chunks than workers, so a worker with big chunks doesn't hold up the rest
+				chunk_count = worker_count * hoof_search_chunks_per_thread ;
+				if ( chunk_count > root_count )
+					{
+					chunk_count = root_count ;
+					}
+				if ( worker_count > chunk_count )
+					{
+					worker_count = chunk_count ;
+					}
+			#endif
+			hoof_memory_calloc( chunks , struct hoof_search_chunk , chunk_count ) ;
+			for ( i = 0 ; i < chunk_count ; i += 1 )
+				{
+				chunks[ i ] . start = hoof_index_value( hoof -> root , i * root_count / chunk_count ) ;
+				chunks[ i ] . stop = hoof_index_value( hoof -> root , ( i + 1 ) * root_count / chunk_count ) ;
+				}
+			for ( i = 0 ; i < worker_count ; i += 1 )
+				{
+				workers[ i ] . chunks = chunks ;
+				workers[ i ] . chunk_count = chunk_count ;
+				workers[ i ] . first = i ;
+				workers[ i ] . step = worker_count ;
+				workers[ i ] . words = words ;
+				workers[ i ] . word_count = hoof -> search_word_count ;
+				workers[ i ] . fill = 0 ;
+				}
+			hoof_search_run( workers , worker_count ) ;
+			// the workers don't allocate, so the results get their room here
+			for ( i = 0 ; i < chunk_count ; i += 1 )
+				{
+				total += chunks[ i ] . count ;
+				}
+			err_passthrough( hoof_search_reserve( hoof , total ) ) ;
+			total = 0 ;
+			for ( i = 0 ; i < chunk_count ; i += 1 )
+				{
+				chunks[ i ] . values = hoof -> search_results + total ;
+				total += chunks[ i ] . count ;
+				}
+			for ( i = 0 ; i < worker_count ; i += 1 )
+				{
+				workers[ i ] . fill = 1 ;
+				}
+			hoof_search_run( workers , worker_count ) ;
+			hoof -> search_result_count = total ;
+			// cleanup
+			cleanup:
+			hoof_memory_free( chunks ) ;
+			return rc ;
+			}
+		static n hoof_search_find( struct hoof * hoof )
+			{
+			/*!	\brief Finds every value that has the search words next to each other.
+				\param[in] hoof struct hoof context.
+				\return n
+
+				With hoof_option_search_index only the values with the rarest of the words
+				are looked at, otherwise hoof_search_scan looks at the whole hierarchy.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_intern * words[ hoof_max_value_length ] ;
+			struct hoof_intern * rarest = NULL ;
+			struct hoof_posting * posting = NULL ;
+			n i = 0 ;
+			// code
+			hoof -> search_result_count = 0 ;
+			hoof -> search_stale = 1 ;
+			err_passthrough( hoof_search_load( hoof ) ) ;
+			// a word no value has means no value has all of them
+			for ( i = 0 ; i < hoof -> search_word_count ; i += 1 )
+				{
+				words[ i ] = hoof_intern_find( hoof , hoof -> search_words[ i ] ) ;
+				if ( words[ i ] == NULL )
+					{
+					hoof -> search_stale = 0 ;
+					goto cleanup ;
+					}
+				if ( rarest == NULL || words[ i ] -> posting_count < rarest -> posting_count )
+					{
+					rarest = words[ i ] ;
+					}
+				}
+			if ( hoof -> options & hoof_option_search_index )
+				{
+				err_passthrough( hoof_search_reserve( hoof , rarest -> posting_count ) ) ;
+				for ( posting = rarest -> postings ; posting != NULL ; posting = posting -> next )
+					{
+					if ( hoof_search_has( posting -> value , words , hoof -> search_word_count ) )
+						{
+						hoof -> search_results[ hoof -> search_result_count ] = posting -> value ;
+						hoof -> search_result_count += 1 ;
+						}
+					}
+				err_passthrough( hoof_values_sort( hoof -> search_results , hoof -> search_result_count , hoof_tree_before ) ) ;
+				}
+			else
+				{
+				err_passthrough( hoof_search_scan( hoof , words ) ) ;
+				}
+			hoof -> search_stale = 0 ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_search_step( struct hoof * hoof , n direction , n * found )
+			{
+			/*!	\brief Goes to a value the search found.
+				\param[in] hoof struct hoof context.
+				\param[in] direction 1 for the next one after the current value, -1 for the one before it,
+					0 for the current value or the next one after it, or the first one if there isn't one.
+				\param[out] found Set if we went to a value, the current value stays the same if we didn't.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			n low = 0 ;
+			n high = 0 ;
+			n middle = 0 ;
+			// code
+			( * found ) = 0 ;
+			if ( hoof -> search_stale )
+				{
+				err_passthrough( hoof_search_find( hoof ) ) ;
+				}
+			// the results are in order, so we find the first one that isn't before the current value,
+			// or with direction 1 the first one that's after it
+			low = 0 ;
+			high = hoof -> search_result_count ;
+			while ( low < high )
+				{
+				middle = low + ( high - low ) / 2 ;
+				if ( direction == 1 ? ! hoof_tree_before( hoof -> current_value , hoof -> search_results[ middle ] ) : hoof_tree_before( hoof -> search_results[ middle ] , hoof -> current_value ) )
+					{
+					low = middle + 1 ;
+					}
+				else
+					{
+					high = middle ;
+					}
+				}
+			if ( direction == -1 )
+				{
+				low -= 1 ;
+				}
+			else if ( direction == 0 && low == hoof -> search_result_count )
+				{
+				low = 0 ;
+				}
+			if ( low < 0 || low >= hoof -> search_result_count )
+				{
+				goto cleanup ;
+				}
+			hoof_make_current_value( hoof , hoof -> search_results[ low ] ) ;
+			( * found ) = 1 ;
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+	// sort
+		static n hoof_sort_words_compare( struct hoof_intern * word_1 , struct hoof_intern * word_2 )
+			{
+			/*!	\brief Compares two words the way sort orders them.
+				\param[in] word_1 First word.
+				\param[in] word_2 Second word.
+				\return less than 0 if word_1 goes first, more than 0 if word_2 does, 0 if they're the same
+
+				Numbers go before other words and are ordered by what they're worth, so 9 goes before 10.
+				Other words are ordered by their bytes.
+				*/
+			// data
+			n number_1 = 0 ;
+			n number_2 = 0 ;
+			n negative = 0 ;
+			n order = 0 ;
+			n i = 0 ;
+			// code
+			if ( word_1 == word_2 )
+				{
+				return 0 ;
+				}
+			// hoof_word_verify only lets numbers start with a digit or a minus
+			number_1 = word_1 -> text[ 0 ] == '-' || ( word_1 -> text[ 0 ] >= '0' && word_1 -> text[ 0 ] <= '9' ) ;
+			number_2 = word_2 -> text[ 0 ] == '-' || ( word_2 -> text[ 0 ] >= '0' && word_2 -> text[ 0 ] <= '9' ) ;
+			if ( number_1 != number_2 )
+				{
+				return number_1 ? -1 : 1 ;
+				}
+			if ( number_1 )
+				{
+				negative = word_1 -> text[ 0 ] == '-' ;
+				if ( negative != ( word_2 -> text[ 0 ] == '-' ) )
+					{
+					return negative ? -1 : 1 ;
+					}
+				// numbers have no leading zeros, so a longer one is further from 0
+				if ( word_1 -> length != word_2 -> length )
+					{
+					order = word_1 -> length < word_2 -> length ? -1 : 1 ;
+					return negative ? - order : order ;
+					}
+				}
+			for ( i = 0 ; word_1 -> text[ i ] == word_2 -> text[ i ] && word_1 -> text[ i ] != '\0' ; i += 1 )
+				{
+				}
+			order = ( n ) word_1 -> text[ i ] - ( n ) word_2 -> text[ i ] ;
+			return number_1 && negative ? - order : order ;
+			}
+		static n hoof_sort_compare( struct hoof_value * value_1 , struct hoof_value * value_2 )
+			{
+			/*!	\brief Compares two values the way sort orders them.
+				\param[in] value_1 First value.
+				\param[in] value_2 Second value.
+				\return less than 0 if value_1 goes first, more than 0 if value_2 does, 0 if they're the same
+
+				Values are compared a word at a time, and a value goes before the values it's the start of.
+				*/
+			// data
+			n order = 0 ;
+			n i = 0 ;
+			// code
+			for ( i = 0 ; i < value_1 -> word_count && i < value_2 -> word_count ; i += 1 )
+				{
+				order = hoof_sort_words_compare( value_1 -> words[ i ] , value_2 -> words[ i ] ) ;
+				if ( order != 0 )
+					{
+					return order ;
+					}
+				}
+			return value_1 -> word_count - value_2 -> word_count ;
+			}
+		static void hoof_sort_page( struct hoof * hoof , struct hoof_value * page , n reverse )
+			{
+			/*!	\brief Sorts the values of a page.
+				\param[in] hoof struct hoof context.
+				\param[in] page Head of the page.
+				\param[in] reverse Set to put the biggest values first.
+				\return void
+
+				The values are merge sorted as a list linked by down, so nothing is allocated and it can't fail.
+				Values that compare the same stay in the order they were in.
+				*/
+			// data
+			struct hoof_value * tail = NULL ;
+			struct hoof_value * list = NULL ;
+			struct hoof_value * last = NULL ;
+			struct hoof_value * left = NULL ;
+			struct hoof_value * right = NULL ;
+			struct hoof_value * value = NULL ;
+			n width = 0 ;
+			n merges = 0 ;
+			n left_size = 0 ;
+			n right_size = 0 ;
+			// code
+			// take the values out as a list that ends in null
+			tail = page -> down ;
+			while ( ! tail -> sentinel )
+				{
+				tail = tail -> down ;
+				}
+			list = page -> down ;
+			tail -> up -> down = NULL ;
+			// merge runs of width values in pairs, doubling width until one merge does the whole list
+			for ( width = 1 ; ; width *= 2 )
+				{
+				left = list ;
+				list = NULL ;
+				last = NULL ;
+				merges = 0 ;
+				while ( left != NULL )
+					{
+					merges += 1 ;
+					right = left ;
+					for ( left_size = 0 ; left_size < width && right != NULL ; left_size += 1 )
+						{
+						right = right -> down ;
+						}
+					right_size = width ;
+					while ( left_size > 0 || ( right_size > 0 && right != NULL ) )
+						{
+						// the left run wins ties, that keeps the sort stable
+						if ( left_size > 0 && ( right_size == 0 || right == NULL || ( reverse ? hoof_sort_compare( right , left ) : hoof_sort_compare( left , right ) ) <= 0 ) )
+							{
+							value = left ;
+							left = left -> down ;
+							left_size -= 1 ;
+							}
+						else
+							{
+							value = right ;
+							right = right -> down ;
+							right_size -= 1 ;
+							}
+						if ( last == NULL )
+							{
+							list = value ;
+							}
+						else
+							{
+							last -> down = value ;
+							}
+						last = value ;
+						}
+					left = right ;
+					}
+				last -> down = NULL ;
+				if ( merges <= 1 )
+					{
+					break ;
+					}
+				}
+			// put the list back between the head and the tail, and build the treap again in the new order
+			page -> index_left = NULL ;
+			last = page ;
+			for ( value = list ; value != NULL ; value = value -> down )
+				{
+				value -> up = last ;
+				last -> down = value ;
+				last = value ;
+				}
+			last -> down = tail ;
+			tail -> up = last ;
+			for ( value = page -> down ; value != tail ; value = value -> down )
+				{
+				hoof_index_add( hoof , value ) ;
+				}
+			hoof_page_dirty( hoof , page -> out ) ;
+			}
+		static n hoof_sort_load( struct hoof * hoof , struct hoof_value * page )
+			{
+			/*!	\brief Loads every page inside a page.
+				\param[in] hoof struct hoof context.
+				\param[in] page Head of the page.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * value = NULL ;
+			// code
+			value = page -> down ;
+			while ( 1 )
+				{
+				if ( ! value -> sentinel )
+					{
+					err_passthrough( hoof_page_load( hoof , value ) ) ;
+					value = value -> in != NULL ? value -> in -> down : value -> down ;
+					continue ;
+					}
+				// a tail, so we go back out unless it's the page's
+				if ( value -> out == page -> out )
+					{
+					break ;
+					}
+				value = value -> out -> down ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
+			}
+		static n hoof_sort( struct hoof * hoof , struct hoof_value * value , n mode )
+			{
+			/*!	\brief Sorts the page a value is in.
+				\param[in] hoof struct hoof context.
+				\param[in] value The value.
+				\param[in] mode hoof_sort_reverse to put the biggest values first, hoof_sort_all to sort the pages inside the page too.
+				\return n
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_value * page = NULL ;
+			// code
+			page = hoof_index_page( value ) ;
+			hoof_sort_page( hoof , page , mode & hoof_sort_reverse ) ;
+			if ( ! ( mode & hoof_sort_all ) )
+				{
+				goto cleanup ;
+				}
+			err_passthrough( hoof_sort_load( hoof , page ) ) ;
+			// each page is sorted before we go in to it, then we go through it in its new order
+			value = page -> down ;
+			while ( 1 )
+				{
+				if ( ! value -> sentinel )
+					{
+					if ( value -> in != NULL )
+						{
+						hoof_sort_page( hoof , value -> in , mode & hoof_sort_reverse ) ;
+						value = value -> in -> down ;
+						}
+					else
+						{
+						value = value -> down ;
+						}
+					continue ;
+					}
+				if ( value -> out == page -> out )
+					{
+					break ;
+					}
+				value = value -> out -> down ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
 			}
 	// drawing
 		static n hoof_word_length( b * word )
@@ -1205,19 +5801,120 @@
 				}
 			return length ;
 			}
-		static void hoof_draw_value( struct hoof * hoof , hoof_draw_function draw_function , struct hoof_value * value , n max_columns , n row , n * row_size , struct hoof_interface * hoof_interface )
+		static void hoof_draw_text( struct hoof_drawer * drawer , n draw_mode , n column , n row , b * text )
+			{
+			/*!	\brief Draws some text, or adds it to the hash of its row.
+				\param[in] drawer How we're drawing.
+				\param[in] draw_mode hoof_draw_normal hoof_draw_current or hoof_draw_cursor.
+				\param[in] column Column of the first character.
+				\param[in] row Row of the text.
+				\param[in] text The text.
+				\return void
+				*/
+			// data
+			b mode = ( b ) draw_mode ;
+			struct hoof_cell * cell = NULL ;
+			// code
+			if ( drawer -> cells != NULL )
+				{
+				if ( row < 1 || row > drawer -> rows )
+					{
+					return ;
+					}
+				cell = drawer -> cells + ( row - 1 ) * drawer -> columns ;
+				for ( ; ( * text ) != '\0' && column <= drawer -> columns ; text += 1 , column += 1 )
+					{
+					if ( column >= 1 )
+						{
+						cell[ column - 1 ] . character = ( * text ) ;
+						cell[ column - 1 ] . draw_mode = mode ;
+						}
+					}
+				// the cursor is a block right after the word being typed, there's always room for it
+				if ( draw_mode == hoof_draw_cursor && column >= 1 && column <= drawer -> columns )
+					{
+					cell[ column - 1 ] . character = ' ' ;
+					cell[ column - 1 ] . draw_mode = mode ;
+					}
+				return ;
+				}
+			if ( drawer -> hashes == NULL )
+				{
+				if ( drawer -> draw_function != NULL )
+					{
+					drawer -> draw_function( draw_mode , column , row , text ) ;
+					}
+				return ;
+				}
+			// only the rows we keep hashes for are drawn
+			if ( row < 1 || row > drawer -> rows )
+				{
+				return ;
+				}
+			if ( drawer -> draw_function == NULL )
+				{
+				// the text's null keeps it apart from whatever is drawn after it
+				drawer -> hashes[ row - 1 ] = hoof_hash_bytes( drawer -> hashes[ row - 1 ] , & mode , 1 ) ;
+				drawer -> hashes[ row - 1 ] = hoof_hash_bytes( drawer -> hashes[ row - 1 ] , ( b * ) & column , sizeof( column ) ) ;
+				drawer -> hashes[ row - 1 ] = hoof_hash_bytes( drawer -> hashes[ row - 1 ] , text , hoof_word_length( text ) + 1 ) ;
+				}
+			else if ( drawer -> previous == NULL || drawer -> previous[ row - 1 ] != drawer -> hashes[ row - 1 ] )
+				{
+				drawer -> draw_function( draw_mode , column , row , text ) ;
+				}
+			}
+		static n hoof_draw_unchanged( struct hoof_drawer * drawer , n row , n count )
+			{
+			/*!	\brief Checks if some rows will be skipped because they're the same as last frame.
+				\param[in] drawer How we're drawing.
+				\param[in] row First row.
+				\param[in] count How many rows.
+				\return 1 if none of the rows would be drawn, 0 otherwise
+				*/
+			// data
+			n i = 0 ;
+			// code
+			if ( drawer -> draw_function == NULL || drawer -> hashes == NULL || drawer -> previous == NULL )
+				{
+				return 0 ;
+				}
+			for ( i = row ; i < row + count ; i += 1 )
+				{
+				if ( i >= 1 && i <= drawer -> rows && drawer -> hashes[ i - 1 ] != drawer -> previous[ i - 1 ] )
+					{
+					return 0 ;
+					}
+				}
+			return 1 ;
+			}
+		static void hoof_draw_value( struct hoof * hoof , struct hoof_drawer * drawer , struct hoof_value * value , n max_columns , n row , n * row_size , struct hoof_interface * hoof_interface )
 			{
 			// data
 			n column = 0 ;
-			struct hoof_word * word = NULL ;
+			n i = 0 ;
+			struct hoof_intern * word = NULL ;
+			n current = -2 ;
 			n word_length = 0 ;
 			b * bullet = NULL ;
+			n typing = 0 ;
 			// code
 			( * row_size ) = 1 ;
-			word = value -> word_head -> right ;
+			// only the current value has a current word
+			if ( hoof -> current_value == value )
+				{
+				current = hoof -> current_word ;
+				}
+			// the value being typed in to changes with every key, so only other values keep their layout
+			typing = ( hoof -> state == hoof_state_new && current != -2 ) ;
+			// measuring, or drawing rows that wouldn't be drawn, doesn't have to go through the words
+			if ( ! typing && value -> layout_columns == max_columns && ( drawer == NULL || hoof_draw_unchanged( drawer , row , value -> layout_rows ) ) )
+				{
+				( * row_size ) = value -> layout_rows ;
+				return ;
+				}
 			// draw bullet
 			// dont want to draw on row 1 because we draw information there
-			if ( draw_function != NULL && row > 1 )
+			if ( drawer != NULL && row > 1 )
 				{
 				if ( value -> in != NULL )
 					{
@@ -1230,11 +5927,11 @@
 				if ( hoof -> current_value == value )
 					{
 					// TODO make a define for what a bullet is
-					draw_function( hoof_draw_current , 1 , row , bullet ) ;
+					hoof_draw_text( drawer , hoof_draw_current , 1 , row , bullet ) ;
 					}
 				else
 					{
-					draw_function( hoof_draw_normal , 1 , row , bullet ) ;
+					hoof_draw_text( drawer , hoof_draw_normal , 1 , row , bullet ) ;
 					}
 				}
 			// draw words
@@ -1242,7 +5939,7 @@
 			while ( 1 )
 				{
 				// if we're in the new state and we're drawing the current word, then we need to draw the current input_word and an extra space where the new words will be inserted
-				if ( hoof -> state == hoof_state_new && hoof -> current_word == word )
+				if ( hoof -> state == hoof_state_new && current == i )
 					{
 					word_length = hoof_word_length( hoof_interface -> input_word ) ;
 					// do we have enough room on the current line ?
@@ -1252,21 +5949,22 @@
 						row += 1 ;
 						( * row_size ) += 1 ;
 						}
-					if ( draw_function != NULL && row > 1 )
+					if ( drawer != NULL && row > 1 )
 						{
-						draw_function( hoof_draw_cursor , column , row , hoof_interface -> input_word ) ;
+						hoof_draw_text( drawer , hoof_draw_cursor , column , row , hoof_interface -> input_word ) ;
 						}
 					column += word_length ;
 					column += 2 ;
 					}
 				// if we're at end of line, we're done
-				if ( word -> value == NULL )
+				if ( i >= value -> word_count )
 					{
 					break;
 					}
-				word_length = hoof_word_length( word -> value ) ;
+				word = value -> words[ i ] ;
+				word_length = word -> length ;
 				// TODO think about this, maybe a function for "is punctuation?"
-				if ( word->value[0] == ',' || word->value[0] == '.' || word->value[0] == '?' || word->value[0] == '!' )
+				if ( word->text[0] == ',' || word->text[0] == '.' || word->text[0] == '?' || word->text[0] == '!' )
 					{
 					if ( column > 3 )
 						{
@@ -1282,51 +5980,68 @@
 					( * row_size ) += 1 ;
 					}
 				// draw word
-				if ( draw_function != NULL && row > 1 )
+				if ( drawer != NULL && row > 1 )
 					{
-					if ( hoof -> state != hoof_state_new && hoof -> current_word == word )
+					if ( hoof -> state != hoof_state_new && current == i )
 						{
-						draw_function( hoof_draw_current , column , row , word -> value ) ;
+						hoof_draw_text( drawer , hoof_draw_current , column , row , word -> text ) ;
 						}
 					else
 						{
-						draw_function( hoof_draw_normal , column , row , word -> value ) ;
+						hoof_draw_text( drawer , hoof_draw_normal , column , row , word -> text ) ;
 						}
 					}
 				// update column
 				column += word_length ;
 				column += 1 ;
 				// next word
-				word = word -> right ;
+				i += 1 ;
+				}
+			if ( ! typing )
+				{
+				value -> layout_columns = max_columns ;
+				value -> layout_rows = ( * row_size ) ;
 				}
 			}
-		// TODO move this into non-static section
-		void hoof_draw( struct hoof * hoof , n max_columns , n max_rows , hoof_draw_function draw_function , struct hoof_interface * hoof_interface )
+		static void hoof_draw_frame( struct hoof * hoof , struct hoof_drawer * drawer , n max_columns , n max_rows , struct hoof_interface * hoof_interface )
 			{
+			/*!	\brief Lays out the screen and passes everything on it to the drawer.
+				\param[in] hoof struct hoof context.
+				\param[in] drawer How we're drawing.
+				\param[in] max_columns Width of the screen.
+				\param[in] max_rows Height of the screen.
+				\param[in] hoof_interface Has the word being typed.
+				\return void
+				*/
 			// data
 			n row = 0 ;
 			n row_size = 0 ;
 			struct hoof_value * value = NULL ;
+			struct hoof_value * first = NULL ;
+			struct hoof_value * last = NULL ;
 			// code
 			// draw title line
-			if ( draw_function != NULL && hoof -> current_value -> out != NULL )
+			if ( hoof -> current_value -> out != NULL )
 				{
-				draw_function( hoof_draw_normal , 1 , 1 , ( b * ) "<" ) ;
+				hoof_draw_text( drawer , hoof_draw_normal , 1 , 1 , ( b * ) "<" ) ;
 				}
 			// draw current value
 			value = hoof -> current_value ;
 			row = max_rows / 2 ;
-			hoof_draw_value( hoof , draw_function , value , max_columns , row , & row_size , hoof_interface ) ;
+			hoof_draw_value( hoof , drawer , value , max_columns , row , & row_size , hoof_interface ) ;
+			first = value ;
+			last = value ;
 			// draw down values until we run out of space or run out of values
 			while ( 1 )
 				{
 				row += row_size ;
 				value = value -> down ;
-				if ( row > max_rows || value -> word_head == NULL )
+				if ( row > max_rows || value -> sentinel )
 					{
 					break ;
 					}
-				hoof_draw_value( hoof , draw_function , value , max_columns , row , & row_size , hoof_interface ) ;
+				hoof_draw_value( hoof , drawer , value , max_columns , row , & row_size , hoof_interface ) ;
+				last = value ;
 				}
 			// draw up values until we run out of space or run out of values
 			value = hoof -> current_value ;
@@ -1334,18 +6049,194 @@
 			while ( 1 )
 				{
 				value = value -> up ;
-				if ( value -> word_head == NULL )
+				if ( value -> sentinel )
 					{
 					break ;
 					}
 				hoof_draw_value( hoof, NULL , value , max_columns , row , & row_size , hoof_interface ) ;
 				row -= row_size ;
-				hoof_draw_value( hoof , draw_function , value , max_columns , row , & row_size , hoof_interface ) ;
+				hoof_draw_value( hoof , drawer , value , max_columns , row , & row_size , hoof_interface ) ;
+				// row 1 is the title line, so a value is on the screen if it has a row below that
+				if ( row + row_size > 2 )
+					{
+					first = value ;
+					}
 				if ( row <= 1 )
 					{
 					break ;
 					}
 				}
+			// the page's treap says where they are, so this doesn't depend on how big the page is
+			hoof -> view_first = hoof_index_of( first ) ;
+			hoof -> view_count = hoof_index_of( last ) - hoof -> view_first + 1 ;
+			}
+		// TODO move this into non-static section
+		void hoof_draw( struct hoof * hoof , n max_columns , n max_rows , hoof_draw_function draw_function , struct hoof_interface * hoof_interface )
+			{
+			// data
+			struct hoof_drawer drawer = { NULL , NULL , NULL , 0 , NULL , 0 } ;
+			// code
+			drawer . draw_function = draw_function ;
+			drawer . rows = max_rows ;
+			hoof_draw_frame( hoof , & drawer , max_columns , max_rows , hoof_interface ) ;
+			}
+		void hoof_draw_changed( struct hoof * hoof , n max_columns , n max_rows , hoof_draw_function draw_function , hoof_clear_function clear_function , struct hoof_interface * hoof_interface )
+			{
+			/*!	\brief Draws the rows that changed since the last time.
+				\param[in] hoof struct hoof context.
+				\param[in] max_columns Width of the screen.
+				\param[in] max_rows Height of the screen.
+				\param[in] draw_function Draws text like it does for hoof_draw.
+				\param[in] clear_function Blanks a row before it's drawn again, can be null.
+				\param[in] hoof_interface Has the word being typed.
+				\return void
+
+				Each row of the frame is hashed, and only rows whose hash is different from the last
+				frame are cleared and drawn. If the screen changed size every row is drawn.
+				Without a clear_function rows are only drawn, like hoof_draw does.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_drawer drawer = { NULL , NULL , NULL , 0 , NULL , 0 } ;
+			n * hashes = NULL ;
+			n row = 0 ;
+			// code
+			if ( max_rows != hoof -> draw_rows || max_columns != hoof -> draw_columns )
+				{
+				hoof_memory_free( hoof -> draw_hashes ) ;
+				hoof_memory_free( hoof -> draw_next ) ;
+				hoof -> draw_rows = 0 ;
+				hoof -> draw_valid = 0 ;
+				if ( max_rows > 0 )
+					{
+					hoof_memory_malloc( hoof -> draw_hashes , n , max_rows ) ;
+					hoof_memory_malloc( hoof -> draw_next , n , max_rows ) ;
+					}
+				hoof -> draw_rows = max_rows ;
+				hoof -> draw_columns = max_columns ;
+				}
+			// hash the new frame
+			for ( row = 0 ; row < max_rows ; row += 1 )
+				{
+				hoof -> draw_next[ row ] = hoof_hash_start ;
+				}
+			drawer . hashes = hoof -> draw_next ;
+			drawer . rows = max_rows ;
+			hoof_draw_frame( hoof , & drawer , max_columns , max_rows , hoof_interface ) ;
+			// clear the rows that changed, then draw only them
+			if ( hoof -> draw_valid )
+				{
+				drawer . previous = hoof -> draw_hashes ;
+				}
+			for ( row = 0 ; row < max_rows ; row += 1 )
+				{
+				if ( clear_function != NULL && ( drawer . previous == NULL || drawer . previous[ row ] != drawer . hashes[ row ] ) )
+					{
+					clear_function( row + 1 ) ;
+					}
+				}
+			drawer . draw_function = draw_function ;
+			hoof_draw_frame( hoof , & drawer , max_columns , max_rows , hoof_interface ) ;
+			hashes = hoof -> draw_hashes ;
+			hoof -> draw_hashes = hoof -> draw_next ;
+			hoof -> draw_next = hashes ;
+			hoof -> draw_valid = 1 ;
+			// cleanup
+			cleanup:
+			// without room for the hashes we draw everything like hoof_draw
+			if ( rc != hoof_rc_success )
+				{
+				hoof_memory_free( hoof -> draw_hashes ) ;
+				hoof_memory_free( hoof -> draw_next ) ;
+				hoof -> draw_rows = 0 ;
+				for ( row = 1 ; clear_function != NULL && row <= max_rows ; row += 1 )
+					{
+					clear_function( row ) ;
+					}
+				hoof_draw( hoof , max_columns , max_rows , draw_function , hoof_interface ) ;
+				}
+			}
+		void hoof_draw_forget( struct hoof * hoof )
+			{
+			hoof -> draw_valid = 0 ;
+			}
+		void hoof_draw_view( struct hoof * hoof , n * first , n * count , n * total )
+			{
+			/*!	\brief Says which values of the current page were on the screen.
+				\param[in] hoof struct hoof context.
+				\param[out] first Position of the first value on the screen, starting at 1.
+				\param[out] count How many values were on the screen, 0 if it hasn't been drawn.
+				\param[out] total How many values the current page has.
+				\return void
+
+				first and count are from the last time the screen was drawn, total is now.
+				*/
+			// code
+			( * first ) = hoof -> view_first + 1 ;
+			( * count ) = hoof -> view_count ;
+			( * total ) = hoof_index_count( hoof_index_page( hoof -> current_value ) ) ;
+			}
+		n hoof_draw_grid( struct hoof * hoof , struct hoof_grid * grid , struct hoof_interface * hoof_interface )
+			{
+			/*!	\brief Draws the screen in to a grid of cells.
+				\param[in] hoof struct hoof context.
+				\param[in,out] grid The client's grid, with what was drawn in to it last time.
+				\param[in] hoof_interface Has the word being typed.
+				\return n
+
+				The frame is drawn in to cells of our own first, then each row that's different
+				from the grid is copied in to it and its dirty bit is set. Cells nothing is drawn in
+				are spaces. If we run out of memory the grid isn't changed.
+				*/
+			// data
+			n rc = hoof_rc_success ;
+			struct hoof_drawer drawer = { NULL , NULL , NULL , 0 , NULL , 0 } ;
+			struct hoof_cell * cells = NULL ;
+			n count = 0 ;
+			n row = 0 ;
+			n i = 0 ;
+			// code
+			err_if( grid == NULL || grid -> columns < 1 || grid -> rows < 1 || grid -> cells == NULL || grid -> dirty == NULL , hoof_rc_error_precond ) ;
+			count = grid -> columns * grid -> rows ;
+			if ( count > hoof -> grid_capacity )
+				{
+				hoof_memory_malloc( cells , struct hoof_cell , count ) ;
+				hoof_memory_free( hoof -> grid_cells ) ;
+				hoof -> grid_cells = cells ;
+				cells = NULL ;
+				hoof -> grid_capacity = count ;
+				}
+			for ( i = 0 ; i < count ; i += 1 )
+				{
+				hoof -> grid_cells[ i ] . character = ' ' ;
+				hoof -> grid_cells[ i ] . draw_mode = hoof_draw_normal ;
+				}
+			drawer . cells = hoof -> grid_cells ;
+			drawer . columns = grid -> columns ;
+			drawer . rows = grid -> rows ;
+			hoof_draw_frame( hoof , & drawer , grid -> columns , grid -> rows , hoof_interface ) ;
+			for ( row = 0 ; row < grid -> rows ; row += 1 )
+				{
+				for ( i = row * grid -> columns ; i < ( row + 1 ) * grid -> columns ; i += 1 )
+					{
+					if ( grid -> cells[ i ] . character != hoof -> grid_cells[ i ] . character || grid -> cells[ i ] . draw_mode != hoof -> grid_cells[ i ] . draw_mode )
+						{
+						break ;
+						}
+					}
+				if ( i == ( row + 1 ) * grid -> columns )
+					{
+					continue ;
+					}
+				for ( i = row * grid -> columns ; i < ( row + 1 ) * grid -> columns ; i += 1 )
+					{
+					grid -> cells[ i ] = hoof -> grid_cells[ i ] ;
+					}
+				grid -> dirty[ row / 8 ] |= ( b ) ( 1 << ( row % 8 ) ) ;
+				}
+			// cleanup
+			cleanup:
+			return rc ;
 			}
 	static void hoof_output( const b * what_to_output, struct hoof_interface *interface )
 		{
@@ -1532,8 +6423,16 @@
 	static void hoof_make_current_value( struct hoof *hoof, struct hoof_value *value )
 		{
 		/* CODE */
+		/* what was on the screen was another page, so go page waits until this one is drawn */
+		if ( hoof->current_value == null || hoof->current_value->out != value->out )
+		{
+			hoof->view_first = 0;
+			hoof->view_count = 0;
+		}
+
 		hoof->current_value = value;
-		hoof->current_word = hoof->current_value->word_head->right;
+		/* the first word, or after the last word if the value is empty */
+		hoof->current_word = 0;
 
 		return;
 		}
@@ -1545,10 +6444,9 @@
 		}
 	static void hoof_most_up( struct hoof *hoof )
 		{
-		while ( hoof->current_value->up->word_head != null )
-		{
-			hoof->current_value = hoof->current_value->up;
-		}
+		/* the page's treap gets us to the page head without walking up the page */
+		hoof->current_value = hoof_index_page( hoof->current_value )->down;
+
 		/* currentvalue is set, but this will also set currentword */
 		hoof_make_current_value( hoof, hoof->current_value );
 
@@ -1556,10 +6454,15 @@
 		}
 	static void hoof_most_down( struct hoof *hoof )
 		{
-		while ( hoof->current_value->down->word_head != null )
-		{
-			hoof->current_value = hoof->current_value->down;
-		}
+		/* DATA */
+		struct hoof_value *page = null;
+
+
+		/* CODE */
+		/* the page's treap gets us to the last value without walking down the page */
+		page = hoof_index_page( hoof->current_value );
+		hoof->current_value = hoof_index_value( page, hoof_index_count( page ) - 1 );
+
 		/* currentvalue is set, but this will also set currentword */
 		hoof_make_current_value( hoof, hoof->current_value );
 
@@ -1574,26 +6477,31 @@
 
 		return;
 		}
-	static void hoof_most_in( struct hoof *hoof )
+	static n hoof_most_in( struct hoof *hoof )
 		{
+		/* DATA */
+		n rc = hoof_rc_success;
+
+
+		/* CODE */
 		while ( hoof->current_value->in != null )
 		{
+			err_passthrough( hoof_page_load( hoof, hoof->current_value ) );
+
 			hoof_make_current_value( hoof, hoof->current_value->in->down );
 		}
 
-		return;
+
+		/* CLEANUP */
+		cleanup:
+
+		return rc;
 		}
 	static n hoof_word_insert( struct hoof *hoof, b *value )
 		{
 		/* DATA */
 		n rc = hoof_rc_success;
 
-		n i = 0;
-
-		struct hoof_word *word = null;
-		struct hoof_word *new_word = null;
-		b *new_value = null;
-
 
 		/* CODE */
 		// TODO verify word is ok here too
@@ -1601,87 +6509,85 @@
 		paranoid_err_if( value[ 0 ] == '\0' );
 
 		/* make sure value isn't too long */
-		i = 0;
-		word = hoof->current_value->word_head->right;
-		while ( word->value != null )
-		{
-			i += 1;
-			word = word->right;
-		}
-
-		err_if( i == hoof_max_value_length, hoof_rc_error_value_long );
-
-		/* insert */
-		hoof_memory_calloc( new_word, struct hoof_word, 1 );
-
-		err_passthrough( hoof_strdup( value, &new_value ) );
-
-		new_word->value = new_value;
-		new_value = null;
+		err_if( hoof->current_value->word_count == hoof_max_value_length, hoof_rc_error_value_long );
 
-		new_word->left = hoof->current_word->left;
-		new_word->right = hoof->current_word;
+		/* insert, current_word stays on the same word which is now one further right */
+		err_passthrough( hoof_word_add( hoof, hoof->current_value, hoof->current_word, value ) );
 
-		hoof->current_word->left->right = new_word;
-		hoof->current_word->left = new_word;
-
-		new_word = null;
+		hoof->current_word += 1;
 
 
 		/* CLEANUP */
 		cleanup:
 
-		hoof_memory_free( new_word );
-		hoof_memory_free( new_value );
-
 		return rc;
 		}
-	static n hoof_value_insert( struct hoof_value *before )
+	static n hoof_word_add( struct hoof * hoof , struct hoof_value * value , n index , b * text )
+		{
+		/*!	\brief Adds a word to a value in front of the word at index.
+			\param[in] hoof struct hoof context.
+			\param[in] value The value.
+			\param[in] index Where the new word goes, word_count puts it after the last word.
+			\param[in] text Text of the new word.
+			\return n
+
+			NOTE: caller is responsible for making sure the value isn't too long.
+			*/
+		// data
+		n rc = hoof_rc_success ;
+		struct hoof_intern * intern = NULL ;
+		n i = 0 ;
+		// code
+		paranoid_err_if( hoof_word_verify( text ) ) ;
+		paranoid_err_if( index < 0 || index > value -> word_count ) ;
+		err_passthrough( hoof_words_reserve( hoof , value , value -> word_count + 1 ) ) ;
+		err_passthrough( hoof_intern_add( hoof , text , & intern ) ) ;
+		err_passthrough( hoof_posting_add( hoof , value , intern ) ) ;
+		for ( i = value -> word_count ; i > index ; i -= 1 )
+			{
+			value -> words[ i ] = value -> words[ i - 1 ] ;
+			}
+		value -> words[ index ] = intern ;
+		value -> word_count += 1 ;
+		value -> layout_columns = 0 ;
+		intern = NULL ;
+		hoof_page_dirty( hoof , value -> out ) ;
+		// cleanup
+		cleanup:
+		if ( intern != NULL )
+			{
+			hoof_intern_release( hoof , intern ) ;
+			}
+		return rc ;
+		}
+	static n hoof_value_insert( struct hoof *hoof, struct hoof_value *before )
 		{
 		/* DATA */
 		n rc = hoof_rc_success;
 
 		struct hoof_value *new_value = null;
-		struct hoof_word *new_word_head = null;
-		struct hoof_word *new_word_tail = null;
 
 
 		/* CODE */
-		hoof_memory_calloc( new_value, struct hoof_value, 1 );
-		hoof_memory_calloc( new_word_head, struct hoof_word, 1 );
-		hoof_memory_calloc( new_word_tail, struct hoof_word, 1 );
-
-		new_word_head->right = new_word_tail;
-
-		new_word_tail->left = new_word_head;
-
-		new_value->word_head = new_word_head;
+		/* the value starts out empty, so it doesn't have a words array yet */
+		hoof_node_calloc( hoof, value_slab, new_value, struct hoof_value );
 
-		new_value->up = before;
-		new_value->down = before->down;
-		
-		before->down->up = new_value;
-		before->down = new_value;
-
-		new_value->out = before->out;
+		hoof_value_link( hoof, new_value, before );
 
-		new_word_head = null;
-		new_word_tail = null;
 		new_value = null;
 
 
 		/* CLEANUP */
 		cleanup:
 
-		hoof_memory_free( new_value );
-		hoof_memory_free( new_word_head );
-		hoof_memory_free( new_word_tail );
+		hoof_node_free( hoof, value_slab, new_value );
 
 		return rc;
 		}
-	static n hoof_page_init( struct hoof_value *parent, n create_empty_value, struct hoof_value **page_A )
+	static n hoof_page_init( struct hoof *hoof, struct hoof_value *parent, n create_empty_value, struct hoof_value **page_A )
 		{
 		/*!	\brief Creates a new page.
+			\param[in] hoof struct hoof context.
 			\param[in] parent Parent of new page. Can be null, but only hoof_init()
 				should pass in null when creating the root page.
 			\param[in] create_empty_value Flag whether the new page should have an empty
@@ -1695,11 +6601,15 @@
 
 		struct hoof_value *new_head = null;
 		struct hoof_value *new_tail = null;
+		struct hoof_page *new_page = null;
 
 
 		/* CODE */
-		hoof_memory_calloc( new_head, struct hoof_value, 1 );
-		hoof_memory_calloc( new_tail, struct hoof_value, 1 );
+		hoof_node_calloc( hoof, value_slab, new_head, struct hoof_value );
+		hoof_node_calloc( hoof, value_slab, new_tail, struct hoof_value );
+		hoof_node_calloc( hoof, page_slab, new_page, struct hoof_page );
+
+		new_head->page = new_page;
 
 		new_head->up = null;
 		new_head->down = new_tail;
@@ -1710,9 +6620,12 @@
 		new_head->out = parent;
 		new_tail->out = parent;
 
+		new_head->sentinel = 1;
+		new_tail->sentinel = 1;
+
 		if ( create_empty_value )
 		{
-			err_passthrough( hoof_value_insert( new_head ) );
+			err_passthrough( hoof_value_insert( hoof, new_head ) );
 		}
 
 		if ( parent != null )
@@ -1727,35 +6640,35 @@
 		}
 		new_head = null;
 		new_tail = null;
+		new_page = null;
 
 
 		/* CLEANUP */
 		cleanup:
 
-		hoof_memory_free( new_head );
-		hoof_memory_free( new_tail );
+		hoof_node_free( hoof, value_slab, new_head );
+		hoof_node_free( hoof, value_slab, new_tail );
+		hoof_node_free( hoof, page_slab, new_page );
 
 		return rc;
 		}
 	static void hoof_value_clear( struct hoof *hoof, struct hoof_value *value )
 		{
 		/* DATA */
-		struct hoof_word *word = null;
-		struct hoof_word *word_to_delete = null;
+		n i = 0;
 
 		/* CODE */
-		word = value->word_head;
-		while ( word->right->value != null )
+		for ( i = 0; i < value->word_count; i += 1 )
 		{
-			word_to_delete = word->right;
-
-			word->right = word->right->right;
-			word->right->left = word;
-
-			hoof_memory_free( word_to_delete->value );
-			hoof_memory_free( word_to_delete );
+			hoof_posting_remove( hoof, value, value->words[ i ] );
+			hoof_intern_release( hoof, value->words[ i ] );
 		}
 
+		value->word_count = 0;
+		value->layout_columns = 0;
+		hoof_words_free( hoof, value );
+		hoof_page_dirty( hoof, value->out );
+
 		/* we may have deleted current word, so fix if necessary */
 		if ( value == hoof->current_value )
 		{
@@ -1764,27 +6677,40 @@
 
 		return;
 		}
-	static void hoof_word_delete( struct hoof *hoof, struct hoof_word *word_to_delete )
+	static void hoof_word_delete( struct hoof *hoof, struct hoof_value *value, n index )
 		{
-		if ( word_to_delete->value != null )
+		/* DATA */
+		n i = 0;
+
+		/* CODE */
+		if ( index >= 0 && index < value->word_count )
 			{
-			word_to_delete->left->right = word_to_delete->right;
-			word_to_delete->right->left = word_to_delete->left;
+			hoof_posting_remove( hoof, value, value->words[ index ] );
+			hoof_intern_release( hoof, value->words[ index ] );
+
+			for ( i = index; i < value->word_count - 1; i += 1 )
+				{
+				value->words[ i ] = value->words[ i + 1 ];
+				}
+			value->word_count -= 1;
+			value->layout_columns = 0;
+			hoof_page_dirty( hoof, value->out );
 
-			if ( hoof->current_word == word_to_delete )
+			if ( value == hoof->current_value )
 				{
-				if ( hoof->current_word->right->value != null )
+				/* words after the deleted one moved left */
+				if ( hoof->current_word > index )
 					{
-					hoof->current_word = hoof->current_word->right;
+					hoof->current_word -= 1;
 					}
-				else
+				/* the deleted word was current, so the word to its right is current now,
+				   or the word to its left if it was the last word,
+				   or after the last word if the value is empty now like hoof_make_current_value does */
+				else if ( hoof->current_word == index && index == value->word_count && index > 0 )
 					{
-					hoof->current_word = hoof->current_word->left;
+					hoof->current_word -= 1;
 					}
 				}
-
-			hoof_memory_free( word_to_delete->value );
-			hoof_memory_free( word_to_delete );
 			}
 
 		return;
@@ -1801,8 +6727,8 @@
 		   if value is only "most out" value, then just delete its
 		   children and clear the value */
 		if (    hoof->current_value->out == null
-			 && hoof->current_value->up->word_head == null
-			 && hoof->current_value->down->word_head == null
+			 && hoof->current_value->up->sentinel
+			 && hoof->current_value->down->sentinel
 		   )
 		{
 			if ( hoof->current_value->in != null )
@@ -1831,31 +6757,27 @@
 		value = value->down;
 
 		/* remove value from list */
-		value->up = value_to_delete->up;
-		value_to_delete->up->down = value;
+		hoof_value_unlink( hoof, value_to_delete );
 
-		/* free value_to_delete */
-		hoof_value_clear( hoof, value_to_delete );        /* words */
-		hoof_memory_free( value_to_delete->word_head->right ); /* word tail */
-		hoof_memory_free( value_to_delete->word_head );        /* word head */
-		hoof_memory_free( value_to_delete );                  /* value */
+		/* free value_to_delete, it was the current value so nothing should look at it now */
+		hoof_value_clear( hoof, value_to_delete );
+		hoof->current_value = null;
+		hoof_value_free( hoof, value_to_delete );
 
 		/* if value is tail */
-		if ( value->word_head == null )
+		if ( value->sentinel )
 		{
 			/* go up */
 			value = value->up;
 
 			/* if value is head */
-			if ( value->word_head == null )
+			if ( value->sentinel )
 			{
 				/* go out */
 				value = value->out;
 
 				/* delete empty in */
-				hoof_memory_free( value->in->down ); /* value tail */
-				hoof_memory_free( value->in );       /* value head */
-				value->in = null;
+				hoof_page_free( hoof, &(value->in) );
 
 				say( "out" );
 			}
@@ -1893,6 +6815,13 @@
 			return;
 		}
 
+		/* unloaded pages are only a head and tail */
+		if ( (*page_F)->page->unloaded )
+		{
+			hoof_page_free( hoof, page_F );
+			return;
+		}
+
 		value = (*page_F)->down;
 
 		while ( 1 )
@@ -1901,8 +6830,15 @@
 			while ( value->in != null )
 			{
 				paranoid_err_if( value->in->out != value );
+
+				if ( value->in->page->unloaded )
+				{
+					hoof_page_free( hoof, &(value->in) );
+					break;
+				}
+
 				value = value->in->down;
-				paranoid_err_if( value->word_head == null );
+				paranoid_err_if( value->sentinel );
 			}
 
 			/* remember value we need to delete */
@@ -1911,18 +6847,16 @@
 			/* goto next value */
 			value = value->down;
 
-			/* remove value from list */
+			/* remove value from list, the whole page goes so its treap isn't kept up */
 			value->up = value_to_delete->up;
 			value_to_delete->up->down = value;
 
 			/* free value_to_delete */
 			hoof_value_clear( hoof, value_to_delete );
-			hoof_memory_free( value_to_delete->word_head->right );
-			hoof_memory_free( value_to_delete->word_head );
-			hoof_memory_free( value_to_delete );
+			hoof_value_free( hoof, value_to_delete );
 
 			/* if value is tail */
-			if ( value->word_head == null )
+			if ( value->sentinel )
 			{
 				/* if we're at tail of our original page */
 				if ( value->up == (*page_F) )
@@ -1930,26 +6864,16 @@
 					break;
 				}
 
-				/* remember value we need to delete */
-				value_to_delete = value;
-
 				/* go out */
 				value = value->out;
 
-				/* set in to null */
-				value->in = null;
-
-				/* free head and tail */
-				hoof_memory_free( value_to_delete->up );
-				hoof_memory_free( value_to_delete );
+				/* free head and tail, and set in to null */
+				hoof_page_free( hoof, &(value->in) );
 			}
 		}
 
 		/* free head and tail */
-		hoof_memory_free( value->up ); /* this is equivalent to (*page_F) */
-		hoof_memory_free( value );
-
-		(*page_F) = null;
+		hoof_page_free( hoof, page_F );
 
 		return;
 		}
@@ -1966,40 +6890,63 @@
 			*/
 		/* DATA */
 		struct hoof_value *temp_value = null;
-		struct hoof_word *temp_word1 = null;
-		struct hoof_word *temp_word2 = null;
+		n next = 0;
+		n i = 0;
 		n match = 0;
 
+		struct hoof_intern *intern = null;
+
 
 		/* CODE */
 		/* if tail */
-		if ( hoof->current_value->word_head == null )
+		if ( hoof->current_value->sentinel )
 		{
 			goto cleanup;
 		}
 
+		/* words with the same text share an intern, so we only compare pointers.
+		   if word isn't interned then no word in the tree has its text and intern stays null */
+		if ( word != null )
+		{
+			intern = hoof_intern_find( hoof, word );
+		}
+
 		/* if next word in current_value matches */
+		next = hoof->current_word + 1;
+
 		if ( word == null )
 		{
-			if ( hoof->current_word->right->value == null )
+			if ( next >= hoof->current_value->word_count )
 			{
 				/* update current_word */
-				hoof->current_word = hoof->current_word->right;
+				hoof->current_word = hoof->current_value->word_count;
 				goto cleanup;
 			}
 		}
 		else
 		{
-			if (    hoof->current_word->right->value != null
-				 && hoof_words_are_same( word, hoof->current_word->right->value )
+			if (    next < hoof->current_value->word_count
+				 && hoof->current_value->words[ next ] == intern
 			   )
 			{
 				/* update current_word */
-				hoof->current_word = hoof->current_word->right;
+				hoof->current_word = next;
 				goto cleanup;
 			}
 		}
 
+		/* a big page can look it up in its dig index instead */
+		if ( hoof_dig_index_search( hoof, intern, word == null ) )
+		{
+			goto cleanup;
+		}
+
+		/* otherwise we only look at the values that matched the words before this one */
+		if ( hoof_dig_candidates_narrow( hoof, intern, word == null ) )
+		{
+			goto cleanup;
+		}
+
 		/* we need to find the next value that matches */
 		temp_value = hoof->current_value;
 		while ( 1 )
@@ -2008,7 +6955,7 @@
 			temp_value = temp_value->down;
 
 			/* if tail */
-			if ( temp_value->word_head == null )
+			if ( temp_value->sentinel )
 			{
 				hoof->current_value = temp_value;
 				goto cleanup;
@@ -2017,24 +6964,16 @@
 			/* do temp_value and current_value match up until current_word? */
 			match = 1;
 
-			temp_word1 = hoof->current_value->word_head;
-			temp_word2 = temp_value->word_head;
-
-			while ( temp_word1 != hoof->current_word )
+			if ( next > temp_value->word_count )
 			{
-				temp_word1 = temp_word1->right;
-				temp_word2 = temp_word2->right;
-
-				if ( temp_word2->value == null )
-				{
-					match = 0;
-					break;
-				}
+				match = 0;
+			}
 
-				if ( ! hoof_words_are_same( temp_word1->value, temp_word2->value ) )
+			for ( i = 0; match && i < next; i += 1 )
+			{
+				if ( hoof->current_value->words[ i ] != temp_value->words[ i ] )
 				{
 					match = 0;
-					break;
 				}
 			}
 
@@ -2042,22 +6981,22 @@
 			{
 				if ( word == null )
 				{
-					if ( temp_word2->right->value == null )
+					if ( next == temp_value->word_count )
 					{
 						hoof->current_value = temp_value;
-						hoof->current_word = temp_word2->right;
+						hoof->current_word = next;
 						goto cleanup;
 					}
 				}
 				else
 				{
 					/* if next word in this value matches */
-					if (    temp_word2->right->value != null
-						 && hoof_words_are_same( temp_word2->right->value, word )
+					if (    next < temp_value->word_count
+						 && temp_value->words[ next ] == intern
 					   )
 					{
 						hoof->current_value = temp_value;
-						hoof->current_word = temp_word2->right;
+						hoof->current_word = next;
 						goto cleanup;
 					}
 				}
@@ -2071,6 +7010,10 @@
 		return;
 		}
 	n hoof_init( b *filename, struct hoof **hoof_A )
+		{
+		return hoof_init_with_options( filename, 0, hoof_A );
+		}
+	n hoof_init_with_options( b *filename, n options, struct hoof **hoof_A )
 		{
 		/* DATA */
 		n rc = hoof_rc_success;
@@ -2079,6 +7022,8 @@
 		struct hoof_value *new_page = null;
 		b *new_filename = null;
 
+		n i = 0;
+
 
 		/* CODE */
 		paranoid_err_if( filename == null );
@@ -2087,11 +7032,25 @@
 
 		err_passthrough( hoof_word_verify( filename ) );
 
+		err_if( ( options & hoof_option_save_text ) && ( options & hoof_option_save_binary ), hoof_rc_error_precond );
+
 		hoof_memory_calloc( new_hoof, struct hoof, 1 );
 
+		new_hoof->options = options;
+		new_hoof->dig_candidate_words = -1;
+
+		hoof_slab_init( &(new_hoof->value_slab), sizeof( struct hoof_value ) );
+		for ( i = 0; i < hoof_word_sizes; i += 1 )
+		{
+			hoof_slab_init( &(new_hoof->word_slabs[ i ]), ( hoof_word_size_smallest << i ) * sizeof( struct hoof_intern * ) );
+		}
+		hoof_slab_init( &(new_hoof->intern_slab), sizeof( struct hoof_intern ) );
+		hoof_slab_init( &(new_hoof->posting_slab), sizeof( struct hoof_posting ) );
+		hoof_slab_init( &(new_hoof->page_slab), sizeof( struct hoof_page ) );
+
 		err_passthrough( hoof_strdup( filename, &new_filename ) );
 
-		err_passthrough( hoof_page_init( null, 1, &new_page ) );
+		err_passthrough( hoof_page_init( new_hoof, null, 1, &new_page ) );
 
 		new_hoof->filename = new_filename;
 		new_filename = null;
@@ -2104,6 +7063,22 @@
 		/* load file */
 		err_passthrough( hoof_load( new_hoof ) );
 
+		/* we save in the format we loaded unless told otherwise */
+		if ( options & hoof_option_save_text )
+		{
+			new_hoof->binary = 0;
+		}
+		else if ( options & hoof_option_save_binary )
+		{
+			new_hoof->binary = 1;
+		}
+
+		/* changing the format means rewriting the file, even with a journal */
+		if ( new_hoof->binary != new_hoof->file_binary )
+		{
+			new_hoof->journal_compact = 1;
+		}
+
 		/* give back */
 		(*hoof_A) = new_hoof;
 		new_hoof = null;
@@ -2122,15 +7097,57 @@
 		}
 	void hoof_free( struct hoof **hoof_F )
 		{
+		/* DATA */
+		n i = 0;
+
+
 		/* CODE */
 		if ( hoof_F == null || (*hoof_F) == null )
 		{
 			goto cleanup;
 		}
 
+		/* a save still being written has to finish before the tree goes away */
+		hoof_save_wait( (*hoof_F) );
+
 		hoof_memory_free( (*hoof_F)->filename );
+		hoof_dictionary_free( (*hoof_F), &((*hoof_F)->dictionary), (*hoof_F)->dictionary_count );
+		hoof_memory_free( (*hoof_F)->journal );
+		hoof_memory_free( (*hoof_F)->dig_candidates );
+		hoof_memory_free( (*hoof_F)->search_results );
+		hoof_memory_free( (*hoof_F)->draw_hashes );
+		hoof_memory_free( (*hoof_F)->draw_next );
+		hoof_memory_free( (*hoof_F)->grid_cells );
+
+		/* dig indexes aren't in the slabs, so they're freed first */
+		while ( (*hoof_F)->dig_indexes != null )
+		{
+			hoof_dig_index_free( (*hoof_F), (*hoof_F)->dig_indexes->page );
+		}
+
+		/* with slabs every node goes away with its block, so we don't walk the tree */
+		if ( (*hoof_F)->options & hoof_option_slab )
+		{
+			(*hoof_F)->root = null;
+
+			hoof_slab_release( &((*hoof_F)->value_slab) );
+			for ( i = 0; i < hoof_word_sizes; i += 1 )
+			{
+				hoof_slab_release( &((*hoof_F)->word_slabs[ i ]) );
+			}
+			hoof_slab_release( &((*hoof_F)->intern_slab) );
+			hoof_slab_release( &((*hoof_F)->posting_slab) );
+			hoof_slab_release( &((*hoof_F)->page_slab) );
+		}
+		else
+		{
+			/* deleting the words gives back every intern */
+			hoof_page_delete( (*hoof_F), &((*hoof_F)->root) );
+
+			paranoid_err_if( (*hoof_F)->intern_count != 0 );
+		}
 
-		hoof_page_delete( (*hoof_F), &((*hoof_F)->root) );
+		hoof_memory_free( (*hoof_F)->interns );
 
 		hoof_memory_free( (*hoof_F) );
 
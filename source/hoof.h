@@ -58,6 +58,27 @@
 		#define hoof_draw_normal 0
 		#define hoof_draw_current 1
 		#define hoof_draw_cursor 2
+		// is a row of a hoof_grid dirty, rows start at 1
+		#define hoof_grid_dirty( grid , row ) ( ( ( grid ) -> dirty[ ( ( row ) - 1 ) / 8 ] >> ( ( ( row ) - 1 ) % 8 ) ) & 1 )
+		// how many bytes a hoof_grid's dirty needs
+		#define hoof_grid_dirty_bytes( rows ) ( ( ( rows ) + 7 ) / 8 )
+		// options for hoof_init_with_options
+		// by default hoof saves in the same format the file was loaded in
+		#define hoof_option_save_text   1
+		#define hoof_option_save_binary 2
+		// only load the root page, other pages are loaded the first time they're used
+		#define hoof_option_lazy        4
+		// save appends edits to filename.journal and only rewrites the file once the journal gets big
+		#define hoof_option_journal     8
+		// save builds the file in memory and writes it on another thread while hoof_do keeps going
+		// the thread needs hoof built with hoof_use_threads, without it the file is written before save returns
+		#define hoof_option_background  16
+		// values and words are handed out from big blocks and reused once they're deleted, hoof_free frees the blocks all at once
+		#define hoof_option_slab        32
+		// dig on a big page uses an index of which values start with which words instead of scanning the page
+		#define hoof_option_dig_index   64
+		// every word knows which values have it, so search only looks at those values instead of the whole hierarchy
+		#define hoof_option_search_index 128
 	// types
 		struct hoof ;
 		struct hoof_interface
@@ -66,10 +87,35 @@
 			b output_value [ hoof_max_value_length + 1 ] [ hoof_max_word_length + 1 ] ;
 			} ;
 		typedef void ( * hoof_draw_function )( n draw_mode , n column , n row , b * text ) ;
+		// hoof_draw_changed calls this before it draws a row again, the row should be left blank
+		// it can be null if the client's draw function doesn't need rows blanked first
+		typedef void ( * hoof_clear_function )( n row ) ;
+		// hoof_draw_grid draws in to a grid of cells that belongs to the client
+		struct hoof_cell
+			{
+			b character ;
+			b draw_mode ;
+			} ;
+		struct hoof_grid
+			{
+			n columns ;
+			n rows ;
+			struct hoof_cell * cells ; // columns * rows cells, a row at a time starting with row 1
+			b * dirty ; // a bit for each row that's set when the row changes, the client clears them once it has drawn the rows
+			} ;
 	// public functions
 		n hoof_init( b * filename , struct hoof * * hoof_a ) ;
+		n hoof_init_with_options( b * filename , n options , struct hoof * * hoof_a ) ;
 		void hoof_free( struct hoof * * hoof_f ) ;
 		void hoof_draw( struct hoof * hoof , n max_columns , n max_rows , hoof_draw_function draw_function , struct hoof_interface * hoof_interface ) ;
+		// like hoof_draw, but only clears and draws the rows that are different from the last time it was called
+		void hoof_draw_changed( struct hoof * hoof , n max_columns , n max_rows , hoof_draw_function draw_function , hoof_clear_function clear_function , struct hoof_interface * hoof_interface ) ;
+		// the next hoof_draw_changed draws every row, for when the screen was cleared
+		void hoof_draw_forget( struct hoof * hoof ) ;
+		// draws in to the grid and sets the dirty bit of every row that changed
+		n hoof_draw_grid( struct hoof * hoof , struct hoof_grid * grid , struct hoof_interface * hoof_interface ) ;
+		// which values of the current page were on the screen the last time it was drawn, for a scrollbar or a header
+		void hoof_draw_view( struct hoof * hoof , n * first , n * count , n * total ) ;
 		n hoof_do( struct hoof * hoof , struct hoof_interface * hoof_interface ) ;
 		const b * hoof_rc_to_string( n rc ) ;
 	#endif
@@ -46,15 +46,54 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 	}
 
 
+/******************************************************************************/
+/* when this is above 0, the allocation that counts it down to 0 fails */
+static int fail_countdown = 0;
+
+/* the biggest allocation hoof has asked for */
+static size_t allocation_largest = 0;
+
+/******************************************************************************/
+static int fail_now( void )
+{
+	if ( fail_countdown > 0 )
+	{
+		fail_countdown -= 1;
+		return fail_countdown == 0;
+	}
+
+	return 0;
+}
+
 /******************************************************************************/
 void *hoof_hook_malloc( size_t size )
 {
+	if ( size > allocation_largest )
+	{
+		allocation_largest = size;
+	}
+
+	if ( fail_now() )
+	{
+		return NULL;
+	}
+
 	return malloc( size );
 }
 
 /******************************************************************************/
 void *hoof_hook_calloc( size_t nmemb, size_t size )
 {
+	if ( nmemb * size > allocation_largest )
+	{
+		allocation_largest = nmemb * size;
+	}
+
+	if ( fail_now() )
+	{
+		return NULL;
+	}
+
 	return calloc( nmemb, size );
 }
 
@@ -100,6 +139,233 @@ void hoof_hook_log( char * library , n line_number , n rc , n a , n b , n c )
 	fflush( stderr ) ;
 }
 
+/******************************************************************************/
+static int write_file( const char *filename, const char *contents, size_t length )
+{
+	FILE *fp = fopen( filename, "w" );
+	size_t written = 0;
+
+	if ( fp == NULL )
+	{
+		return -1;
+	}
+
+	written = fwrite( contents, 1, length, fp );
+	fclose( fp );
+
+	return written == length ? 0 : -1;
+}
+
+/******************************************************************************/
+static size_t read_file( const char *filename, char *contents, size_t size )
+{
+	FILE *fp = fopen( filename, "r" );
+	size_t length = 0;
+
+	if ( fp == NULL )
+	{
+		return 0;
+	}
+
+	length = fread( contents, 1, size - 1, fp );
+	contents[ length ] = '\0';
+	fclose( fp );
+
+	return length;
+}
+
+/******************************************************************************/
+static int do_words( struct hoof *hoof, const char *words )
+{
+	struct hoof_interface interface;
+	size_t i = 0;
+	int rc = 0;
+
+	while ( words[ 0 ] != '\0' )
+	{
+		i = 0;
+		while ( words[ i ] != ' ' && words[ i ] != '\0' )
+		{
+			interface.input_word[ i ] = words[ i ];
+			i += 1;
+		}
+		interface.input_word[ i ] = '\0';
+
+		rc = hoof_do( hoof, &interface );
+		if ( rc != hoof_rc_success )
+		{
+			return rc;
+		}
+
+		words += i;
+		if ( words[ 0 ] == ' ' )
+		{
+			words += 1;
+		}
+	}
+
+	return 0;
+}
+
+/******************************************************************************/
+/* runs words on a fresh copy of contents once for each allocation, with that allocation failing,
+   then once more with nothing failing, and returns how the last run went */
+static int fail_every_allocation( n options, const char *contents, const char *words )
+{
+	struct hoof *hoof = NULL;
+	int i = 0;
+	int rc = 0;
+
+	for ( i = 1; ; i += 1 )
+	{
+		remove( "miscbinary.journal" );
+		if ( write_file( "miscbinary", contents, strlen( contents ) ) != 0 )
+		{
+			return -1;
+		}
+
+		fail_countdown = i;
+
+		rc = hoof_init_with_options( "miscbinary", options, &hoof );
+		if ( rc == hoof_rc_success )
+		{
+			rc = do_words( hoof, words );
+		}
+
+		hoof_free( &hoof );
+
+		/* running out of memory is the only way it may fail */
+		if ( rc != hoof_rc_success && rc != hoof_rc_error_memory )
+		{
+			fail_countdown = 0;
+			return rc;
+		}
+
+		/* every allocation has had a turn failing */
+		if ( fail_countdown > 0 )
+		{
+			fail_countdown = 0;
+			return rc;
+		}
+	}
+}
+
+/******************************************************************************/
+/* a screen for the draw tests, drawing writes in to it and clearing a row blanks it */
+#define screen_rows 12
+#define screen_columns 40
+static char screen[ screen_rows + 1 ][ screen_columns + 1 ];
+static n screen_modes[ screen_rows + 1 ][ screen_columns + 1 ];
+static int screen_draws = 0;
+
+static void screen_draw( n draw_mode, n column, n row, b *text )
+{
+	screen_draws += 1;
+
+	if ( row < 1 || row > screen_rows )
+	{
+		return;
+	}
+
+	while ( text[ 0 ] != '\0' && column <= screen_columns )
+	{
+		if ( column >= 1 )
+		{
+			screen[ row ][ column ] = text[ 0 ];
+			screen_modes[ row ][ column ] = draw_mode;
+		}
+
+		column += 1;
+		text += 1;
+	}
+}
+
+static void screen_clear( n row )
+{
+	n column = 0;
+
+	for ( column = 1; column <= screen_columns; column += 1 )
+	{
+		screen[ row ][ column ] = ' ';
+		screen_modes[ row ][ column ] = hoof_draw_normal;
+	}
+}
+
+/* fills the screen with junk, so we can tell the rows that weren't drawn */
+static void screen_junk( void )
+{
+	n row = 0;
+	n column = 0;
+
+	for ( row = 1; row <= screen_rows; row += 1 )
+	{
+		for ( column = 1; column <= screen_columns; column += 1 )
+		{
+			screen[ row ][ column ] = 'x';
+			screen_modes[ row ][ column ] = hoof_draw_cursor;
+		}
+	}
+}
+
+/* is the screen what hoof_draw would draw on a blank screen */
+static int screen_matches( struct hoof *hoof, n columns, struct hoof_interface *interface )
+{
+	static char drawn[ screen_rows + 1 ][ screen_columns + 1 ];
+	static n drawn_modes[ screen_rows + 1 ][ screen_columns + 1 ];
+	int draws = screen_draws;
+	int same = 0;
+	n row = 0;
+
+	memcpy( drawn, screen, sizeof( screen ) );
+	memcpy( drawn_modes, screen_modes, sizeof( screen_modes ) );
+
+	for ( row = 1; row <= screen_rows; row += 1 )
+	{
+		screen_clear( row );
+	}
+	hoof_draw( hoof, columns, screen_rows, screen_draw, interface );
+
+	same = memcmp( drawn, screen, sizeof( screen ) ) == 0 && memcmp( drawn_modes, screen_modes, sizeof( screen_modes ) ) == 0;
+
+	memcpy( screen, drawn, sizeof( screen ) );
+	memcpy( screen_modes, drawn_modes, sizeof( screen_modes ) );
+	screen_draws = draws;
+
+	return same;
+}
+
+/* is the grid what hoof_draw would draw on a blank screen, apart from the block after the word being typed */
+static int grid_matches( struct hoof *hoof, struct hoof_grid *grid, struct hoof_interface *interface )
+{
+	n row = 0;
+	n column = 0;
+	struct hoof_cell *cell = NULL;
+
+	for ( row = 1; row <= screen_rows; row += 1 )
+	{
+		screen_clear( row );
+	}
+	hoof_draw( hoof, grid->columns, grid->rows, screen_draw, interface );
+
+	for ( row = 1; row <= grid->rows; row += 1 )
+	{
+		for ( column = 1; column <= grid->columns; column += 1 )
+		{
+			cell = &( grid->cells[ ( row - 1 ) * grid->columns + column - 1 ] );
+			if ( cell->draw_mode == hoof_draw_cursor && cell->character == ' ' && screen[ row ][ column ] == ' ' )
+			{
+				continue;
+			}
+			if ( cell->character != screen[ row ][ column ] || cell->draw_mode != screen_modes[ row ][ column ] )
+			{
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
 /******************************************************************************/
 int main( int argc, char **argv )
 {
@@ -108,11 +374,29 @@ int main( int argc, char **argv )
 
 	struct hoof *hoof = NULL;
 	struct hoof_interface interface;
+	struct hoof_cell cells[ screen_rows * screen_columns ];
+	b dirty[ hoof_grid_dirty_bytes( screen_rows ) ];
+	struct hoof_grid grid = { screen_columns, screen_rows, NULL, NULL };
+	n first = 0;
+	n count = 0;
+	n total = 0;
 
 	const char *rc_string = NULL;
 
 	int i = 0;
 
+	const char *text =
+		"new right one two done\n"
+		"new in three done\n"
+		"new in literal literal literal done literal pause done\n"
+		"out\n"
+		"out\n"
+		"new down one two two done\n";
+	char contents[ 1024 ];
+	char big[ 8192 ];
+	size_t length = 0;
+	FILE *fp = NULL;
+
 
 	/* CODE */
 	/* test NULL to hoof_free */
@@ -152,6 +436,649 @@ int main( int argc, char **argv )
 	rc = hoof_do( hoof, &interface );
 	test_err_if( rc != hoof_rc_error_word_long );
 
+	hoof_free( &hoof );
+
+	/* test asking for both save formats */
+	rc = hoof_init_with_options( "miscdata", hoof_option_save_text | hoof_option_save_binary, &hoof );
+	test_err_if( rc != hoof_rc_error_precond );
+	test_err_if( hoof != NULL );
+
+	/* test saving a text file as binary */
+	test_err_if( write_file( "miscbinary", text, strlen( text ) ) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_save_binary, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "save" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	length = read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( length < 5 || memcmp( contents, "hoof", 5 ) != 0 );
+	test_err_if( length >= strlen( text ) );
+
+	/* test loading a binary file */
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "in" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "in" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "value" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+	test_err_if( strcmp( interface.output_value[ 1 ], "literal" ) != 0 );
+	test_err_if( strcmp( interface.output_value[ 2 ], "done" ) != 0 );
+	test_err_if( strcmp( interface.output_value[ 3 ], "pause" ) != 0 );
+
+	/* saving without options keeps the binary format */
+	strcpy( interface.input_word, "save" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	length = read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( length < 5 || memcmp( contents, "hoof", 5 ) != 0 );
+
+	/* test saving a binary file as text gives back what we started with */
+	rc = hoof_init_with_options( "miscbinary", hoof_option_save_text, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "save" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents, text ) != 0 );
+
+	/* test bad binary files */
+	test_err_if( write_file( "miscbinary", "hoof\0\3\0", 7 ) != 0 );
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_error_file_bad );
+
+	test_err_if( write_file( "miscbinary", "hoof\0\2\1\3one\0\1\1", 14 ) != 0 );
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_error_file_bad );
+
+	test_err_if( write_file( "miscbinary", "hoof\0\2\1\3one\0\1\0\4", 15 ) != 0 );
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_error_file_bad );
+
+	test_err_if( write_file( "miscbinary", "hoof\0\2\1\3o~e\0\1\0", 14 ) != 0 );
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_error_word_bad );
+
+	test_err_if( write_file( "miscbinary", "hoof\0\2\1\3one\0\1", 13 ) != 0 );
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_error_file_bad );
+
+	/* a dictionary that says it has millions of words but ends straight away */
+	allocation_largest = 0;
+	test_err_if( write_file( "miscbinary", "hoof\0\2\x80\x80\x80\x7f", 9 ) != 0 );
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_error_file_bad );
+	test_err_if( allocation_largest > 1024 * 1024 );
+
+	test_err_if( write_file( "miscbinary", "hoof\0\2\1\3one\0\1\0\1\0", 16 ) != 0 );
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	/* test lazy loading a text file */
+	test_err_if( write_file( "miscbinary", text, strlen( text ) ) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_lazy, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "most" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "in" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "value" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+	test_err_if( strcmp( interface.output_value[ 1 ], "literal" ) != 0 );
+	test_err_if( strcmp( interface.output_value[ 2 ], "done" ) != 0 );
+
+	/* pages we never looked at still get saved */
+	strcpy( interface.input_word, "save" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents, text ) != 0 );
+
+	/* test lazy loading a binary file */
+	rc = hoof_init_with_options( "miscbinary", hoof_option_save_binary, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "save" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_lazy, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "in" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "value" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+	test_err_if( strcmp( interface.output_value[ 1 ], "three" ) != 0 );
+
+	hoof_free( &hoof );
+
+	/* test deleting a value whose page was never loaded */
+	rc = hoof_init_with_options( "miscbinary", hoof_option_lazy | hoof_option_save_text, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "delete" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "value" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	strcpy( interface.input_word, "save" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents, "new right one two two done\n" ) != 0 );
+
+	/* test saving edits to a journal */
+	test_err_if( write_file( "miscbinary", text, strlen( text ) ) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_journal, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "most down new down four done move up in in delete word save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	/* the file itself doesn't change */
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents, text ) != 0 );
+	test_err_if( read_file( "miscbinary.journal", contents, sizeof( contents ) ) == 0 );
+
+	/* more edits are added to the same journal */
+	rc = hoof_init_with_options( "miscbinary", hoof_option_journal, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "in new in five done clear new right six done save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	/* a cut off edit at the end of the journal is left out */
+	fp = fopen( "miscbinary.journal", "a" );
+	test_err_if( fp == NULL );
+	fputs( "word 1 0 1 seven", fp );
+	fclose( fp );
+
+	/* opening without a journal still reads it, and saving puts everything in the file */
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents,
+		"new right one two done\n"
+		"new in three done\n"
+		"new in six done\n"
+		"new down literal literal literal done literal pause done\n"
+		"out\n"
+		"out\n"
+		"new down done\n"
+		"new down one two two done\n"
+		) != 0 );
+	test_err_if( read_file( "miscbinary.journal", contents, sizeof( contents ) ) != 0 );
+
+	/* a journal for some other file is ignored */
+	test_err_if( write_file( "miscbinary.journal", "journal 1 2\nclear 1 0\n", 22 ) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_journal, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "value" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	/* the journal gets folded in to the file once it's big enough */
+	rc = hoof_init_with_options( "miscbinary", hoof_option_journal, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	for ( i = 0; i < 200000; i += 1 )
+	{
+		rc = do_words( hoof, "clear" );
+		test_err_if( rc != hoof_rc_success );
+	}
+
+	rc = do_words( hoof, "save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	test_err_if( read_file( "miscbinary.journal", contents, sizeof( contents ) ) != 0 );
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strncmp( contents, "new right done\n", 15 ) != 0 );
+
+	/* test saving in the background */
+	test_err_if( write_file( "miscbinary", text, strlen( text ) ) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_background, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	/* edits after a save don't end up in it */
+	rc = do_words( hoof, "most down delete value save save root delete value" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents,
+		"new right one two done\n"
+		"new in three done\n"
+		"new in literal literal literal done literal pause done\n"
+		"out\n"
+		"out\n"
+		) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_background | hoof_option_journal | hoof_option_save_binary, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "new down four done quit" );
+	test_err_if( rc != hoof_rc_quit );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents, "hoof" ) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_save_text, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents,
+		"new right one two done\n"
+		"new in three done\n"
+		"new in literal literal literal done literal pause done\n"
+		"out\n"
+		"out\n"
+		"new down four done\n"
+		) != 0 );
+
+	/* test that saving a file that didn't change leaves it alone */
+	test_err_if( write_file( "miscbinary", "new right one done\r\nnew down two done\r\n", 40 ) != 0 );
+
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "most up save quit" );
+	test_err_if( rc != hoof_rc_quit );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents, "new right one done\r\nnew down two done\r\n" ) != 0 );
+
+	/* test that pages that didn't change are copied from the old file */
+	test_err_if( write_file( "miscbinary", text, strlen( text ) ) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_lazy, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "most down new down four done save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strncmp( contents, text, strlen( text ) ) != 0 );
+	test_err_if( strcmp( contents + strlen( text ), "new down four done\n" ) != 0 );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_save_binary, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	/* the copied pages move, so a second save has to find them where the first one put them */
+	rc = hoof_init_with_options( "miscbinary", hoof_option_lazy, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "in new down five done save out most down delete value save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	rc = hoof_init_with_options( "miscbinary", hoof_option_save_text, &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents,
+		"new right one two done\n"
+		"new in three done\n"
+		"new in literal literal literal done literal pause done\n"
+		"out\n"
+		"new down five done\n"
+		"out\n"
+		"new down one two two done\n"
+		) != 0 );
+
+	/* test values and words from slabs, running out of memory at each allocation */
+	rc = fail_every_allocation( hoof_option_slab, text,
+		"most down delete value new down four done in new down five six done delete value new down seven done save" );
+	test_err_if( rc != hoof_rc_success );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents,
+		"new right one two done\n"
+		"new in three done\n"
+		"new in literal literal literal done literal pause done\n"
+		"out\n"
+		"out\n"
+		"new down four done\n"
+		"new down seven done\n"
+		) != 0 );
+
+	/* test dig with a dig index, a page of 300 values is big enough to get one */
+	length = 0;
+	for ( i = 0; i < 300; i += 1 )
+	{
+		length += sprintf( big + length, "new %s %d %d done\n", i == 0 ? "right" : "down", i % 7, i );
+	}
+
+	/* running out of memory for the index just means dig scans the page */
+	rc = fail_every_allocation( hoof_option_dig_index, big,
+		"go 10 down dig 5 250 done clear new right found done go most up dig 0 77 done delete value dig 5 cancel save" );
+	test_err_if( rc != hoof_rc_success );
+
+	read_file( "miscbinary", big, sizeof( big ) );
+	test_err_if( strstr( big, "new down 4 249 done\nnew down found done\nnew down 6 251 done\n" ) == NULL );
+	test_err_if( strstr( big, "new down 0 77 done\n" ) != NULL );
+	test_err_if( strstr( big, "new down 5 12 done\n" ) == NULL );
+
+	/* test search with a search index, the page with x b c y isn't loaded until search needs it */
+	rc = fail_every_allocation( hoof_option_search_index | hoof_option_lazy,
+		"new right a b c done\n"
+		"new in x b c y done\n"
+		"out\n"
+		"new down b c done\n"
+		"new down c b done\n",
+		"search b c done next delete value next clear new right d done save" );
+	test_err_if( rc != hoof_rc_success );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents,
+		"new right a b c done\n"
+		"new down d done\n"
+		"new down c b done\n"
+		) != 0 );
+
+	/* test sort all to the journal, the pages inside are loaded first so a failed load leaves nothing half sorted */
+	rc = fail_every_allocation( hoof_option_journal | hoof_option_lazy,
+		"new right b done\n"
+		"new in 10 done\n"
+		"new down -2 done\n"
+		"new down 9 done\n"
+		"out\n"
+		"new down a done\n",
+		"sort all reverse save" );
+	test_err_if( rc != hoof_rc_success );
+
+	/* the sort comes back from the journal, and the next edit without one writes it to the file */
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	rc = do_words( hoof, "new down c done save" );
+	test_err_if( rc != hoof_rc_success );
+
+	hoof_free( &hoof );
+
+	read_file( "miscbinary", contents, sizeof( contents ) );
+	test_err_if( strcmp( contents,
+		"new right b done\n"
+		"new in 10 done\n"
+		"new down 9 done\n"
+		"new down -2 done\n"
+		"out\n"
+		"new down c done\n"
+		"new down a done\n"
+		) != 0 );
+
+	/* test drawing only the rows that changed */
+	length = 0;
+	for ( i = 0; i < 30; i += 1 )
+	{
+		length += sprintf( big + length, "new %s %d%s done\n", i == 0 ? "right" : "down", i, i % 4 == 0 ? " and some words that wrap on to another row" : "" );
+	}
+	test_err_if( write_file( "miscbinary", big, length ) != 0 );
+
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	interface.input_word[ 0 ] = '\0';
+
+	/* the first time every row is cleared and drawn */
+	screen_junk();
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	test_err_if( ! screen_matches( hoof, screen_columns, &interface ) );
+
+	/* nothing changed so nothing is drawn */
+	screen_draws = 0;
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	test_err_if( screen_draws != 0 );
+
+	/* moving scrolls the page, and the word being typed is only on its row */
+	rc = do_words( hoof, "go 3 down" );
+	test_err_if( rc != hoof_rc_success );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	test_err_if( screen_draws == 0 || ! screen_matches( hoof, screen_columns, &interface ) );
+
+	rc = do_words( hoof, "new down" );
+	test_err_if( rc != hoof_rc_success );
+	strcpy( ( char * ) interface.input_word, "typing" );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	test_err_if( ! screen_matches( hoof, screen_columns, &interface ) );
+
+	/* just the new value's bullet and the word */
+	screen_draws = 0;
+	strcpy( ( char * ) interface.input_word, "typings" );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	test_err_if( screen_draws != 2 || ! screen_matches( hoof, screen_columns, &interface ) );
+
+	/* without a clear function the rows that changed are still drawn */
+	screen_draws = 0;
+	strcpy( ( char * ) interface.input_word, "typist" );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, NULL, &interface );
+	test_err_if( screen_draws != 2 );
+	interface.input_word[ 0 ] = '\0';
+
+	/* forgetting draws every row again */
+	screen_junk();
+	hoof_draw_forget( hoof );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	test_err_if( ! screen_matches( hoof, screen_columns, &interface ) );
+
+	/* without memory for the rows everything is drawn */
+	screen_junk();
+	fail_countdown = 1;
+	hoof_draw_changed( hoof, screen_columns - 10, screen_rows, screen_draw, screen_clear, &interface );
+	fail_countdown = 0;
+	test_err_if( ! screen_matches( hoof, screen_columns - 10, &interface ) );
+
+	/* a value above the current value that gets more words takes more rows, */
+	/* so the screen is what a hoof that never drew the value before draws */
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	rc = do_words( hoof, "done go 2 up new right and more words that wrap on to another row done go 2 down save" );
+	test_err_if( rc != hoof_rc_success );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+
+	hoof_free( &hoof );
+
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_success );
+	rc = do_words( hoof, "go 4 down" );
+	test_err_if( rc != hoof_rc_success );
+	test_err_if( ! screen_matches( hoof, screen_columns, &interface ) );
+
+	/* test drawing in to a grid, a row is dirty when it's different from what was in the grid */
+	grid.cells = cells;
+	grid.dirty = dirty;
+	for ( i = 0; i < screen_rows * screen_columns; i += 1 )
+	{
+		cells[ i ].character = ' ';
+		cells[ i ].draw_mode = hoof_draw_normal;
+	}
+	memset( dirty, 0, sizeof( dirty ) );
+
+	rc = hoof_draw_grid( hoof, &grid, &interface );
+	test_err_if( rc != hoof_rc_success );
+	test_err_if( ! grid_matches( hoof, &grid, &interface ) );
+	/* the title row is blank in the root page, the row of the current value isn't */
+	test_err_if( hoof_grid_dirty( &grid, 1 ) || ! hoof_grid_dirty( &grid, screen_rows / 2 ) );
+
+	/* nothing changed so no row is dirty */
+	memset( dirty, 0, sizeof( dirty ) );
+	rc = hoof_draw_grid( hoof, &grid, &interface );
+	test_err_if( rc != hoof_rc_success );
+	for ( i = 1; i <= screen_rows; i += 1 )
+	{
+		test_err_if( hoof_grid_dirty( &grid, i ) );
+	}
+
+	/* the word being typed has a block after it */
+	rc = do_words( hoof, "new down" );
+	test_err_if( rc != hoof_rc_success );
+	strcpy( ( char * ) interface.input_word, "typing" );
+	rc = hoof_draw_grid( hoof, &grid, &interface );
+	test_err_if( rc != hoof_rc_success );
+	test_err_if( ! grid_matches( hoof, &grid, &interface ) );
+	test_err_if( ! hoof_grid_dirty( &grid, screen_rows / 2 ) );
+	test_err_if( cells[ ( screen_rows / 2 - 1 ) * screen_columns + 2 + 6 ].draw_mode != hoof_draw_cursor );
+	test_err_if( cells[ ( screen_rows / 2 - 1 ) * screen_columns + 2 + 6 ].character != ' ' );
+	interface.input_word[ 0 ] = '\0';
+
+	/* a bigger grid needs more memory, and without it the grid stays the same */
+	memcpy( big, cells, sizeof( cells ) );
+	grid.rows = screen_rows + 1;
+	fail_countdown = 1;
+	rc = hoof_draw_grid( hoof, &grid, &interface );
+	fail_countdown = 0;
+	test_err_if( rc != hoof_rc_error_memory );
+	test_err_if( memcmp( big, cells, sizeof( cells ) ) != 0 );
+
+	grid.cells = NULL;
+	rc = hoof_draw_grid( hoof, &grid, &interface );
+	test_err_if( rc != hoof_rc_error_precond );
+
+	hoof_free( &hoof );
+
+	/* test which values are on the screen, and going a screen of values at a time */
+	length = 0;
+	for ( i = 0; i < 100; i += 1 )
+	{
+		length += sprintf( big + length, "new %s %d done\n", i == 0 ? "right" : "down", i );
+	}
+	test_err_if( write_file( "miscbinary", big, length ) != 0 );
+
+	rc = hoof_init( "miscbinary", &hoof );
+	test_err_if( rc != hoof_rc_success );
+
+	/* nothing is on the screen until it's drawn */
+	hoof_draw_view( hoof, &first, &count, &total );
+	test_err_if( first != 1 || count != 0 || total != 100 );
+
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	hoof_draw_view( hoof, &first, &count, &total );
+	test_err_if( first != 1 || count != 7 || total != 100 );
+
+	/* the current value is in the middle of the screen, so the screen starts 4 values before value 8 */
+	rc = do_words( hoof, "go page down" );
+	test_err_if( rc != hoof_rc_success );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	hoof_draw_view( hoof, &first, &count, &total );
+	test_err_if( first != 4 || count != screen_rows - 1 || total != 100 );
+	test_err_if( ! screen_matches( hoof, screen_columns, &interface ) );
+
+	/* a new value counts straight away */
+	rc = do_words( hoof, "new down 100 done go page up" );
+	test_err_if( rc != hoof_rc_success );
+	hoof_draw_view( hoof, &first, &count, &total );
+	test_err_if( first != 4 || count != screen_rows - 1 || total != 101 );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	hoof_draw_view( hoof, &first, &count, &total );
+	test_err_if( first != 1 || total != 101 );
+
+	/* a page is values on the screen, so it doesn't go through words */
+	rc = do_words( hoof, "go page" );
+	test_err_if( rc != hoof_rc_success );
+	strcpy( interface.input_word, "right" );
+	rc = hoof_do( hoof, &interface );
+	test_err_if( rc != hoof_rc_success );
+	test_err_if( strcmp( interface.output_value[ 0 ], "huh" ) != 0 );
+	interface.input_word[ 0 ] = '\0';
+	rc = do_words( hoof, "cancel" );
+	test_err_if( rc != hoof_rc_success );
+
+	/* another page hasn't been drawn yet, and neither has this one once we come back to it */
+	rc = do_words( hoof, "new in a done" );
+	test_err_if( rc != hoof_rc_success );
+	hoof_draw_view( hoof, &first, &count, &total );
+	test_err_if( first != 1 || count != 0 || total != 1 );
+	rc = do_words( hoof, "out" );
+	test_err_if( rc != hoof_rc_success );
+	hoof_draw_view( hoof, &first, &count, &total );
+	test_err_if( first != 1 || count != 0 || total != 101 );
+	hoof_draw_changed( hoof, screen_columns, screen_rows, screen_draw, screen_clear, &interface );
+	hoof_draw_view( hoof, &first, &count, &total );
+	test_err_if( count == 0 );
+
+	hoof_free( &hoof );
+
 	/* signal success */
 	rc = 0;
 
@@ -161,6 +1088,9 @@ int main( int argc, char **argv )
 
 	hoof_free( &hoof );
 
+	remove( "miscbinary" );
+	remove( "miscbinary.journal" );
+
 	return rc;
 }
 